@@ -0,0 +1,289 @@
+// Good: Closest-pair queries over point sets as part of Point's interface in namespace geometry
+// Looking for near-duplicates by calling distance() on every pair is O(n^2).
+//
+//   closest_pair:  divide and conquer on x, merge-sorting by y on the way back up
+//                  so the strip around each split is already y-ordered. Halves
+//                  above a cutoff are solved on separate threads.
+//   closest_pairs: the k closest pairs by plane sweep. Points are visited in x
+//                  order while an active set ordered by y holds those within the
+//                  current k-th best distance; each new point is compared only to
+//                  active points inside that y window.
+//
+// Both compare squared distances and take a single sqrt per reported pair.
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <limits>
+#include <queue>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+double distance(const Point& p1, const Point& p2) {
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Indices into the input, first < second
+struct PointPair {
+    std::size_t first, second;
+    double distance;
+};
+
+namespace detail {
+
+struct Entry {
+    double x, y;
+    std::uint32_t id;
+};
+
+struct Best {
+    double d2 = std::numeric_limits<double>::infinity();
+    std::uint32_t a = 0, b = 0;
+
+    void offer(const Entry& p, const Entry& q) {
+        const double dx = p.x - q.x, dy = p.y - q.y;
+        const double d = dx * dx + dy * dy;
+        if (d < d2) { d2 = d; a = p.id; b = q.id; }
+    }
+};
+
+constexpr std::size_t bruteForceCutoff = 8;
+constexpr std::size_t parallelCutoff = 1 << 16;
+
+// a[0, n) is x-sorted on entry and y-sorted on return; buf[0, n) is scratch
+Best closest(Entry* a, Entry* buf, std::size_t n, int spawnDepth) {
+    Best best;
+    if (n <= bruteForceCutoff) {
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = i + 1; j < n; ++j) best.offer(a[i], a[j]);
+        }
+        std::sort(a, a + n, [](const Entry& p, const Entry& q) { return p.y < q.y; });
+        return best;
+    }
+
+    const std::size_t mid = n / 2;
+    const double midX = a[mid].x;
+    Best left, right;
+    if (spawnDepth > 0 && n > parallelCutoff) {
+        auto future = std::async(std::launch::async,
+                                 [=] { return closest(a, buf, mid, spawnDepth - 1); });
+        right = closest(a + mid, buf + mid, n - mid, spawnDepth - 1);
+        left = future.get();
+    } else {
+        left = closest(a, buf, mid, 0);
+        right = closest(a + mid, buf + mid, n - mid, 0);
+    }
+    best = left.d2 <= right.d2 ? left : right;
+
+    std::merge(a, a + mid, a + mid, a + n, buf,
+               [](const Entry& p, const Entry& q) { return p.y < q.y; });
+    std::copy(buf, buf + n, a);
+
+    // Strip around the split, already in y order; each point needs only its
+    // successors whose dy is still below the best distance
+    std::size_t stripSize = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double dx = a[i].x - midX;
+        if (dx * dx < best.d2) buf[stripSize++] = a[i];
+    }
+    for (std::size_t i = 0; i < stripSize; ++i) {
+        for (std::size_t j = i + 1; j < stripSize; ++j) {
+            const double dy = buf[j].y - buf[i].y;
+            if (dy * dy >= best.d2) break;
+            best.offer(buf[i], buf[j]);
+        }
+    }
+    return best;
+}
+
+std::vector<Entry> sortedByX(const Point* points, std::size_t n) {
+    if (n > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("closest pair: more than 2^32 points");
+    }
+    std::vector<Entry> entries(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        entries[i] = Entry{points[i].x(), points[i].y(), static_cast<std::uint32_t>(i)};
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& p, const Entry& q) { return p.x < q.x || (p.x == q.x && p.y < q.y); });
+    return entries;
+}
+
+PointPair makePair(std::uint32_t a, std::uint32_t b, double d2) {
+    return PointPair{std::min<std::size_t>(a, b), std::max<std::size_t>(a, b), std::sqrt(d2)};
+}
+
+} // namespace detail
+
+// ============================================================================
+// Interface
+// ============================================================================
+
+// Closest pair among points[0, n); throws for fewer than two points
+PointPair closest_pair(const Point* points, std::size_t n, unsigned threads = 0) {
+    if (n < 2) {
+        throw std::invalid_argument("closest_pair: need at least two points");
+    }
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    int spawnDepth = 0;
+    while ((1u << spawnDepth) < threads) ++spawnDepth;
+
+    std::vector<detail::Entry> entries = detail::sortedByX(points, n);
+    std::vector<detail::Entry> buffer(n);
+    detail::Best best = detail::closest(entries.data(), buffer.data(), n, spawnDepth);
+    return detail::makePair(best.a, best.b, best.d2);
+}
+
+// The k closest pairs among points[0, n), nearest first (fewer if n is small)
+std::vector<PointPair> closest_pairs(const Point* points, std::size_t n, std::size_t k) {
+    std::vector<PointPair> result;
+    if (n < 2 || k == 0) {
+        return result;
+    }
+    const std::vector<detail::Entry> byX = detail::sortedByX(points, n);
+
+    // Max-heap of the best k so far; its top is the current bound
+    using Candidate = std::pair<double, std::pair<std::uint32_t, std::uint32_t>>;
+    std::priority_queue<Candidate> heap;
+    auto bound = [&] {
+        return heap.size() < k ? std::numeric_limits<double>::infinity() : heap.top().first;
+    };
+
+    std::set<std::pair<double, std::size_t>> active;   // (y, position in byX)
+    std::size_t tail = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const detail::Entry& p = byX[i];
+
+        // Retire points that are too far left to beat the bound
+        while (tail < i) {
+            const double dx = p.x - byX[tail].x;
+            if (dx * dx < bound()) break;
+            active.erase({byX[tail].y, tail});
+            ++tail;
+        }
+
+        const double limit = bound();
+        auto it = (limit == std::numeric_limits<double>::infinity())
+                      ? active.begin()
+                      : active.lower_bound({p.y - std::sqrt(limit), 0});
+        for (; it != active.end(); ++it) {
+            const detail::Entry& q = byX[it->second];
+            const double dy = q.y - p.y;
+            if (dy > 0 && dy * dy >= bound()) break;
+            const double dx = q.x - p.x;
+            const double d2 = dx * dx + dy * dy;
+            if (d2 < bound()) {
+                if (heap.size() == k) heap.pop();
+                heap.push({d2, {q.id, p.id}});
+            }
+        }
+        active.insert({p.y, i});
+    }
+
+    result.resize(heap.size());
+    for (std::size_t r = heap.size(); r-- > 0; heap.pop()) {
+        result[r] = detail::makePair(heap.top().second.first, heap.top().second.second,
+                                     heap.top().first);
+    }
+    return result;
+}
+
+PointPair closest_pair(const std::vector<Point>& points, unsigned threads = 0) {
+    return closest_pair(points.data(), points.size(), threads);
+}
+
+std::vector<PointPair> closest_pairs(const std::vector<Point>& points, std::size_t k) {
+    return closest_pairs(points.data(), points.size(), k);
+}
+
+} // namespace geometry
+
+namespace {
+
+std::vector<geometry::Point> randomPoints(std::size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<double> coord(0.0, 1e6);
+    std::vector<geometry::Point> points;
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) points.emplace_back(coord(rng), coord(rng));
+    return points;
+}
+
+// The O(n^2) loop this replaces, kept as the reference for the checks below
+std::vector<double> bruteForceDistances(const std::vector<geometry::Point>& points, std::size_t k) {
+    std::vector<double> all;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        for (std::size_t j = i + 1; j < points.size(); ++j) all.push_back(distance(points[i], points[j]));
+    }
+    std::sort(all.begin(), all.end());
+    all.resize(std::min(k, all.size()));
+    return all;
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv) {
+    const std::size_t maxN = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::mt19937 rng(57);
+
+    // Correctness against brute force, including duplicates and collinear input
+    int failures = 0;
+    for (int trial = 0; trial < 200; ++trial) {
+        std::vector<geometry::Point> points = randomPoints(2 + trial * 3, rng);
+        if (trial % 5 == 0) points.push_back(points[trial % points.size()]);
+        if (trial % 7 == 0) {
+            for (auto& p : points) p = geometry::Point(p.x(), 1.0);
+        }
+        const std::size_t k = 1 + trial % 10;
+        std::vector<double> expected = bruteForceDistances(points, k);
+
+        if (closest_pair(points).distance != expected[0]) ++failures;  // ADL
+        std::vector<geometry::PointPair> pairs = closest_pairs(points, k);
+        if (pairs.size() != expected.size()) { ++failures; continue; }
+        for (std::size_t r = 0; r < pairs.size(); ++r) {
+            if (pairs[r].distance != expected[r]) { ++failures; break; }
+        }
+    }
+    std::cout << "Brute-force cross-check: " << failures << " failures in 200 trials\n";
+
+    // Scaling
+    using Clock = std::chrono::steady_clock;
+    std::cout << "n, closest_pair ms, closest_pairs(k=10) ms\n";
+    for (std::size_t n = 1000; n <= maxN; n *= 10) {
+        std::vector<geometry::Point> points = randomPoints(n, rng);
+        auto t0 = Clock::now();
+        geometry::PointPair best = closest_pair(points);
+        auto t1 = Clock::now();
+        std::vector<geometry::PointPair> top = closest_pairs(points, 10);
+        auto t2 = Clock::now();
+        std::cout << n << ", " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+                  << ", " << std::chrono::duration<double, std::milli>(t2 - t1).count()
+                  << "   (closest " << best.distance << ", agree: "
+                  << (top.front().distance == best.distance ? "yes" : "no") << ")\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,510 @@
+// Good: Clustering as its own namespace, built on geometry's Point interface
+// Clustering is a consumer of geometry rather than part of Point's interface,
+// so it gets a nested namespace (geometry::cluster, Rule 58) and is called with
+// qualified names. It never calls distance() one pair at a time:
+//
+//   k-means: k-means++ seeding, then Lloyd iterations. The assignment step runs
+//   over SoA copies of the coordinates and centroids. It takes points eight at
+//   a time and keeps a branch-free running min/argmin per point while looping
+//   over the centroids, so the eight-wide loop over points vectorizes. Each
+//   thread accumulates private partial sums that are merged in thread order,
+//   so no locks or atomics touch the hot loop.
+//
+//   DBSCAN: neighbourhoods come from a uniform grid with cell size eps, built
+//   by counting sort, so each query inspects the 3 x 3 surrounding cells. Core
+//   points are found in parallel; the flood fill that labels clusters is serial
+//   and checks the time budget as it goes.
+//
+// Both take iteration / time budgets and report per-phase timings.
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+double distance(const Point& p1, const Point& p2) {
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+namespace cluster {
+
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+struct Budget {
+    std::size_t maxIterations = 100;
+    Milliseconds maxTime = Milliseconds(std::numeric_limits<double>::infinity());
+};
+
+namespace detail {
+
+template <typename Body>
+void parallelBlocks(std::size_t n, unsigned threads, Body body) {
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(body, t, n * t / threads, n * (t + 1) / threads);
+    }
+    body(0u, std::size_t(0), n / threads);
+    for (auto& th : pool) th.join();
+}
+
+unsigned resolveThreads(unsigned threads, std::size_t n) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    return n < 10000 ? 1u : threads;
+}
+
+// Nearest of k SoA centroids for W consecutive points. The argmin update is
+// arithmetic rather than a branch or select, which GCC would otherwise leave
+// as control flow; the loop over the W points then vectorizes. Labels are
+// doubles so they share the lane width of the distances.
+template <std::size_t W>
+void nearestCentroid(const double* xs, const double* ys, const double* cx, const double* cy,
+                     std::size_t k, double* best, double* label) {
+    for (std::size_t l = 0; l < W; ++l) {
+        best[l] = std::numeric_limits<double>::infinity();
+        label[l] = 0.0;
+    }
+    for (std::size_t c = 0; c < k; ++c) {
+        const double px = cx[c], py = cy[c], pc = static_cast<double>(c);
+        for (std::size_t l = 0; l < W; ++l) {
+            const double dx = xs[l] - px, dy = ys[l] - py;
+            const double d2 = dx * dx + dy * dy;
+            const double closer = d2 < best[l] ? 1.0 : 0.0;
+            label[l] += closer * (pc - label[l]);
+            best[l] = std::min(d2, best[l]);
+        }
+    }
+}
+
+} // namespace detail
+
+// ============================================================================
+// k-means
+// ============================================================================
+
+struct KMeansOptions {
+    std::size_t k = 8;
+    Budget budget;
+    double tolerance = 1e-6;       // stop when no centroid moves further than this
+    unsigned threads = 0;          // 0 = hardware_concurrency()
+    std::uint32_t seed = 1;
+};
+
+struct KMeansResult {
+    std::vector<Point> centroids;
+    std::vector<std::uint32_t> labels;
+    double inertia = 0.0;          // sum of squared distances to assigned centroid
+    std::size_t iterations = 0;
+    bool converged = false;
+
+    struct Timings {
+        Milliseconds seeding{0}, assignment{0}, update{0}, total{0};
+    } timings;
+};
+
+KMeansResult kmeans(const Point* points, std::size_t n, const KMeansOptions& options) {
+    const std::size_t k = options.k;
+    if (k == 0 || k > n) {
+        throw std::invalid_argument("kmeans: k must be in [1, n]");
+    }
+    const auto start = Clock::now();
+    const unsigned threads = detail::resolveThreads(options.threads, n);
+
+    std::vector<double> xs(n), ys(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        xs[i] = points[i].x();
+        ys[i] = points[i].y();
+    }
+
+    KMeansResult result;
+    result.labels.assign(n, 0);
+
+    // k-means++: each next centre is drawn with probability ~ squared distance
+    // to the nearest centre chosen so far
+    std::mt19937 rng(options.seed);
+    std::vector<double> cx, cy, nearest(n, std::numeric_limits<double>::infinity());
+    std::size_t first = std::uniform_int_distribution<std::size_t>(0, n - 1)(rng);
+    cx.push_back(xs[first]);
+    cy.push_back(ys[first]);
+    while (cx.size() < k) {
+        const double px = cx.back(), py = cy.back();
+        double total = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const double dx = xs[i] - px, dy = ys[i] - py;
+            nearest[i] = std::min(nearest[i], dx * dx + dy * dy);
+            total += nearest[i];
+        }
+        double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+        std::size_t pick = n - 1;
+        for (std::size_t i = 0; i < n; ++i) {
+            target -= nearest[i];
+            if (target <= 0.0) { pick = i; break; }
+        }
+        cx.push_back(xs[pick]);
+        cy.push_back(ys[pick]);
+    }
+    auto phase = Clock::now();
+    result.timings.seeding = phase - start;
+
+    struct Partial {
+        std::vector<double> sx, sy;
+        std::vector<std::size_t> count;
+        double inertia = 0.0;
+    };
+    std::vector<Partial> partials(threads);
+
+    while (result.iterations < options.budget.maxIterations &&
+           Clock::now() - start < options.budget.maxTime) {
+        ++result.iterations;
+
+        // Assignment: nearest centroid per point, summed into per-thread partials
+        detail::parallelBlocks(n, threads, [&](unsigned t, std::size_t begin, std::size_t end) {
+            Partial& p = partials[t];
+            p.sx.assign(k, 0.0);
+            p.sy.assign(k, 0.0);
+            p.count.assign(k, 0);
+            p.inertia = 0.0;
+            constexpr std::size_t block = 8;
+            double best[block], label[block];
+            for (std::size_t i = begin; i < end; i += block) {
+                const std::size_t m = std::min(block, end - i);
+                if (m == block) {
+                    detail::nearestCentroid<block>(&xs[i], &ys[i], cx.data(), cy.data(), k, best, label);
+                } else {
+                    for (std::size_t l = 0; l < m; ++l) {
+                        detail::nearestCentroid<1>(&xs[i + l], &ys[i + l], cx.data(), cy.data(), k,
+                                                   &best[l], &label[l]);
+                    }
+                }
+                for (std::size_t l = 0; l < m; ++l) {
+                    const auto c = static_cast<std::uint32_t>(label[l]);
+                    result.labels[i + l] = c;
+                    p.sx[c] += xs[i + l];
+                    p.sy[c] += ys[i + l];
+                    ++p.count[c];
+                    p.inertia += best[l];
+                }
+            }
+        });
+        auto assigned = Clock::now();
+        result.timings.assignment += assigned - phase;
+
+        // Update: merge partials in thread order and move the centroids
+        double maxShift2 = 0.0;
+        result.inertia = 0.0;
+        for (std::size_t c = 0; c < k; ++c) {
+            double sx = 0.0, sy = 0.0;
+            std::size_t count = 0;
+            for (const Partial& p : partials) {
+                sx += p.sx[c];
+                sy += p.sy[c];
+                count += p.count[c];
+            }
+            if (count == 0) continue;   // empty cluster keeps its centre
+            const double nx = sx / count, ny = sy / count;
+            maxShift2 = std::max(maxShift2, (nx - cx[c]) * (nx - cx[c]) + (ny - cy[c]) * (ny - cy[c]));
+            cx[c] = nx;
+            cy[c] = ny;
+        }
+        for (const Partial& p : partials) result.inertia += p.inertia;
+        phase = Clock::now();
+        result.timings.update += phase - assigned;
+
+        if (maxShift2 <= options.tolerance * options.tolerance) {
+            result.converged = true;
+            break;
+        }
+    }
+
+    for (std::size_t c = 0; c < k; ++c) result.centroids.emplace_back(cx[c], cy[c]);
+    result.timings.total = Clock::now() - start;
+    return result;
+}
+
+// ============================================================================
+// DBSCAN
+// ============================================================================
+
+struct DbscanOptions {
+    double eps = 1.0;
+    std::size_t minPoints = 5;     // including the point itself
+    Budget budget;                 // maxIterations is unused; maxTime bounds expansion
+    unsigned threads = 0;          // 0 = hardware_concurrency(); used for core detection
+};
+
+struct DbscanResult {
+    static constexpr std::int32_t noise = -1;
+    static constexpr std::int32_t unvisited = -2;  // left behind when the time budget ran out
+
+    std::vector<std::int32_t> labels;
+    std::size_t clusters = 0;
+    bool complete = true;
+
+    struct Timings {
+        Milliseconds index{0}, core{0}, expansion{0}, total{0};
+    } timings;
+};
+
+namespace detail {
+
+// Uniform grid over the input with cell size eps, in CSR form
+class EpsGrid {
+private:
+    double minX_, minY_, inv_;
+    std::size_t cols_, rows_;
+    std::vector<std::uint32_t> start_, items_;
+
+    // Offsets are taken on halved coordinates, so v - lo cannot overflow even
+    // for points near +-DBL_MAX; the index is clamped before the cast
+    std::size_t cellIndex(double v, double lo, std::size_t count) const {
+        const double c = (0.5 * v - 0.5 * lo) * (2.0 * inv_);
+        return c < static_cast<double>(count - 1) ? static_cast<std::size_t>(c) : count - 1;
+    }
+    std::size_t col(double x) const { return cellIndex(x, minX_, cols_); }
+    std::size_t row(double y) const { return cellIndex(y, minY_, rows_); }
+
+public:
+    EpsGrid(const Point* points, std::size_t n, double eps) {
+        minX_ = minY_ = std::numeric_limits<double>::infinity();
+        double maxX = -minX_, maxY = -minY_;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!std::isfinite(points[i].x()) || !std::isfinite(points[i].y())) {
+                throw std::invalid_argument("dbscan: point coordinates must be finite");
+            }
+            minX_ = std::min(minX_, points[i].x()); maxX = std::max(maxX, points[i].x());
+            minY_ = std::min(minY_, points[i].y()); maxY = std::max(maxY, points[i].y());
+        }
+        // Half extents are finite for any finite input; inv_ starts finite even
+        // for a denormal eps (coarser cells are still at least eps wide)
+        const double halfX = 0.5 * maxX - 0.5 * minX_, halfY = 0.5 * maxY - 0.5 * minY_;
+        inv_ = 1.0 / std::max(eps, std::numeric_limits<double>::min());
+        // Cap the cell count at ~4 cells per point; sparse extents get coarser
+        // cells. Spans that overflow to inf also halve inv_, and the loop ends
+        // once inv_ is near 1 / extent, long before it could reach zero.
+        const double cap = 4.0 * n + 16;
+        auto cells = [&](double half) { return 2.0 * (half * inv_); };
+        while ((cells(halfX) + 1) * (cells(halfY) + 1) > cap) inv_ *= 0.5;
+        cols_ = static_cast<std::size_t>(std::min(cells(halfX), cap)) + 1;
+        rows_ = static_cast<std::size_t>(std::min(cells(halfY), cap)) + 1;
+
+        start_.assign(cols_ * rows_ + 1, 0);
+        std::vector<std::uint32_t> cell(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            cell[i] = static_cast<std::uint32_t>(row(points[i].y()) * cols_ + col(points[i].x()));
+            ++start_[cell[i] + 1];
+        }
+        for (std::size_t c = 0; c + 1 < start_.size(); ++c) start_[c + 1] += start_[c];
+        items_.resize(n);
+        std::vector<std::uint32_t> cursor(start_.begin(), start_.end() - 1);
+        for (std::size_t i = 0; i < n; ++i) items_[cursor[cell[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    // Counts points within eps of points[i], stopping once limit is reached
+    std::size_t countWithin(const Point* points, std::uint32_t i, double eps2,
+                            std::size_t limit) const {
+        std::size_t count = 0;
+        const std::size_t c = col(points[i].x()), r = row(points[i].y());
+        for (std::size_t rr = (r ? r - 1 : 0); rr <= std::min(rows_ - 1, r + 1); ++rr) {
+            for (std::size_t cc = (c ? c - 1 : 0); cc <= std::min(cols_ - 1, c + 1); ++cc) {
+                const std::size_t cellIndex = rr * cols_ + cc;
+                for (std::uint32_t k = start_[cellIndex]; k < start_[cellIndex + 1]; ++k) {
+                    const std::uint32_t j = items_[k];
+                    const double dx = points[j].x() - points[i].x(), dy = points[j].y() - points[i].y();
+                    if (dx * dx + dy * dy <= eps2 && ++count >= limit) return count;
+                }
+            }
+        }
+        return count;
+    }
+
+    // Appends every point within eps of points[i]; cells are at least eps wide
+    void neighbours(const Point* points, std::uint32_t i, double eps2,
+                    std::vector<std::uint32_t>& out) const {
+        out.clear();
+        const std::size_t c = col(points[i].x()), r = row(points[i].y());
+        for (std::size_t rr = (r ? r - 1 : 0); rr <= std::min(rows_ - 1, r + 1); ++rr) {
+            for (std::size_t cc = (c ? c - 1 : 0); cc <= std::min(cols_ - 1, c + 1); ++cc) {
+                const std::size_t cellIndex = rr * cols_ + cc;
+                for (std::uint32_t k = start_[cellIndex]; k < start_[cellIndex + 1]; ++k) {
+                    const std::uint32_t j = items_[k];
+                    const double dx = points[j].x() - points[i].x(), dy = points[j].y() - points[i].y();
+                    if (dx * dx + dy * dy <= eps2) out.push_back(j);
+                }
+            }
+        }
+    }
+};
+
+} // namespace detail
+
+DbscanResult dbscan(const Point* points, std::size_t n, const DbscanOptions& options) {
+    if (!(options.eps > 0) || !std::isfinite(options.eps)) {
+        throw std::invalid_argument("dbscan: eps must be positive and finite");
+    }
+    const auto start = Clock::now();
+    DbscanResult result;
+    result.labels.assign(n, DbscanResult::unvisited);
+    if (n == 0) {
+        return result;
+    }
+
+    const detail::EpsGrid grid(points, n, options.eps);
+    const auto indexed = Clock::now();
+    result.timings.index = indexed - start;
+
+    // Core detection: independent per point, so it is split across threads
+    const double eps2 = options.eps * options.eps;
+    std::vector<std::uint8_t> core(n, 0);
+    detail::parallelBlocks(n, detail::resolveThreads(options.threads, n),
+                           [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            core[i] = grid.countWithin(points, static_cast<std::uint32_t>(i), eps2,
+                                       options.minPoints) >= options.minPoints;
+        }
+    });
+    const auto classified = Clock::now();
+    result.timings.core = classified - indexed;
+
+    // Expansion: flood fill from each unclaimed core point. Every point is
+    // claimed at most once, and only core points are queried again. The budget
+    // is checked every 256 neighbourhood queries, so one huge cluster cannot
+    // overrun it; a cluster cut short keeps the labels it has so far.
+    std::vector<std::uint32_t> seeds, found;
+    std::int32_t cluster = 0;
+    std::size_t queries = 0;
+    for (std::uint32_t i = 0; i < n && result.complete; ++i) {
+        if (!core[i] || result.labels[i] != DbscanResult::unvisited) continue;
+        if (Clock::now() - start >= options.budget.maxTime) {
+            result.complete = false;
+            break;
+        }
+
+        result.labels[i] = cluster;
+        seeds.assign(1, i);
+        while (!seeds.empty()) {
+            if (++queries % 256 == 0 && Clock::now() - start >= options.budget.maxTime) {
+                result.complete = false;
+                break;
+            }
+            const std::uint32_t j = seeds.back();
+            seeds.pop_back();
+            grid.neighbours(points, j, eps2, found);
+            for (std::uint32_t m : found) {
+                if (result.labels[m] != DbscanResult::unvisited) continue;
+                result.labels[m] = cluster;
+                if (core[m]) seeds.push_back(m);
+            }
+        }
+        ++cluster;
+    }
+
+    // Whatever no cluster reached is noise (unless the budget cut us short)
+    if (result.complete) {
+        for (std::int32_t& label : result.labels) {
+            if (label == DbscanResult::unvisited) label = DbscanResult::noise;
+        }
+    }
+
+    result.clusters = static_cast<std::size_t>(cluster);
+    result.timings.expansion = Clock::now() - classified;
+    result.timings.total = Clock::now() - start;
+    return result;
+}
+
+} // namespace cluster
+
+} // namespace geometry
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 500000;
+
+    // Eight Gaussian blobs plus uniform background noise
+    std::mt19937 rng(57);
+    std::uniform_real_distribution<double> uniform(0.0, 1000.0);
+    std::normal_distribution<double> spread(0.0, 40.0);
+    std::vector<geometry::Point> centres;
+    for (int c = 0; c < 8; ++c) centres.emplace_back(uniform(rng), uniform(rng));
+    std::vector<geometry::Point> points;
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i % 20 == 0) {
+            points.emplace_back(uniform(rng), uniform(rng));
+        } else {
+            const geometry::Point& c = centres[i % centres.size()];
+            points.emplace_back(c.x() + spread(rng), c.y() + spread(rng));
+        }
+    }
+
+    namespace cl = geometry::cluster;
+
+    cl::KMeansOptions km;
+    km.k = 8;
+    km.budget.maxIterations = 50;
+    cl::KMeansResult kr = cl::kmeans(points.data(), points.size(), km);
+    std::cout << "k-means: " << kr.iterations << " iterations, "
+              << (kr.converged ? "converged" : "budget exhausted")
+              << ", inertia " << kr.inertia << "\n";
+    std::cout << "  seeding " << kr.timings.seeding.count() << " ms, assignment "
+              << kr.timings.assignment.count() << " ms, update " << kr.timings.update.count()
+              << " ms, total " << kr.timings.total.count() << " ms\n";
+
+    cl::DbscanOptions db;
+    db.eps = 3.0;
+    db.minPoints = 20;
+    cl::DbscanResult dr = cl::dbscan(points.data(), points.size(), db);
+    std::size_t noise = std::count(dr.labels.begin(), dr.labels.end(), cl::DbscanResult::noise);
+    std::cout << "DBSCAN: " << dr.clusters << " clusters, " << noise << " noise points"
+              << (dr.complete ? "" : " (time budget hit)") << "\n";
+    std::cout << "  index " << dr.timings.index.count() << " ms, core detection "
+              << dr.timings.core.count() << " ms, expansion "
+              << dr.timings.expansion.count() << " ms, total " << dr.timings.total.count() << " ms\n";
+
+    // A tight budget stops early and says so
+    cl::DbscanOptions rushed = db;
+    rushed.budget.maxTime = dr.timings.core + dr.timings.index;
+    cl::DbscanResult partial = cl::dbscan(points.data(), points.size(), rushed);
+    std::cout << "DBSCAN with no time left for expansion: " << (partial.complete ? "complete" : "stopped early")
+              << " after " << partial.clusters << " clusters\n";
+
+    // Extreme but valid input: finite points near +-DBL_MAX and a denormal eps
+    const std::vector<geometry::Point> extreme = {geometry::Point(-1e308, 1e308), geometry::Point(1e308, -1e308),
+                                                  geometry::Point(0.0, 0.0), geometry::Point(0.0, 0.0)};
+    cl::DbscanOptions wide;
+    wide.eps = 1.0;
+    wide.minPoints = 2;
+    cl::DbscanOptions tiny = wide;
+    tiny.eps = 1e-310;
+    cl::DbscanResult wideResult = cl::dbscan(extreme.data(), extreme.size(), wide);
+    cl::DbscanResult tinyResult = cl::dbscan(extreme.data(), extreme.size(), tiny);
+    std::cout << "DBSCAN near +-1e308: " << wideResult.clusters << " cluster(s) with eps 1, "
+              << tinyResult.clusters << " with eps 1e-310 (expected 1 and 1)\n";
+
+    // Sanity check against the scalar interface
+    std::cout << "Distance between first two k-means centroids: "
+              << distance(kr.centroids[0], kr.centroids[1]) << "\n";
+
+    return 0;
+}
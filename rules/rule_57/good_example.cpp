@@ -2,38 +2,156 @@
 
 #include <iostream>
 #include <cmath>
+#include <cstdint>
+#include <type_traits>
 
 namespace geometry {
 
-class Point {
+// Q16.16 fixed-point coordinate: 16 integer bits, 16 fractional bits
+class Fixed16 {
 private:
-    double x_, y_;
+    std::int32_t raw_;
+
+    struct RawTag {};
+    constexpr Fixed16(std::int32_t raw, RawTag) : raw_(raw) {}
+
+    // Values outside [-32768, 32768) saturate instead of overflowing; NaN becomes 0
+    static constexpr std::int32_t saturate(double scaled) {
+        if (!(scaled == scaled)) return 0;
+        if (scaled >= 2147483647.0) return INT32_MAX;
+        if (scaled <= -2147483648.0) return INT32_MIN;
+        return static_cast<std::int32_t>(scaled);
+    }
+
+public:
+    static constexpr int fractionBits = 16;
+
+    constexpr Fixed16() : raw_(0) {}
+    constexpr Fixed16(int value)
+        : raw_(saturate(static_cast<double>(value) * (1 << fractionBits))) {}
+    constexpr explicit Fixed16(double value)
+        : raw_(saturate(value * (1 << fractionBits))) {}
+
+    static constexpr Fixed16 fromRaw(std::int32_t raw) { return Fixed16(raw, RawTag{}); }
+
+    constexpr std::int32_t raw() const { return raw_; }
+    constexpr explicit operator double() const {
+        return static_cast<double>(raw_) / (1 << fractionBits);
+    }
+
+    friend constexpr Fixed16 operator+(Fixed16 a, Fixed16 b) { return fromRaw(a.raw_ + b.raw_); }
+    friend constexpr Fixed16 operator-(Fixed16 a, Fixed16 b) { return fromRaw(a.raw_ - b.raw_); }
+    friend constexpr Fixed16 operator/(Fixed16 a, int d) { return fromRaw(a.raw_ / d); }
+    friend constexpr bool operator==(Fixed16 a, Fixed16 b) { return a.raw_ == b.raw_; }
+};
+
+std::ostream& operator<<(std::ostream& os, Fixed16 f) {
+    return os << static_cast<double>(f);
+}
+
+template <typename T>
+class BasicPoint {
+private:
+    T x_, y_;
 
 public:
-    Point(double x, double y) : x_(x), y_(y) {}
+    using value_type = T;
+
+    constexpr BasicPoint(T x, T y) : x_(x), y_(y) {}
 
-    double x() const { return x_; }
-    double y() const { return y_; }
+    constexpr T x() const { return x_; }
+    constexpr T y() const { return y_; }
 };
 
+// Existing callers keep using Point unchanged
+using Point = BasicPoint<double>;
+
+namespace detail {
+
+// float points measure in float; int32 and fixed-point coordinates measure in
+// double so dx * dx cannot overflow
+template <typename T>
+using distance_t = std::conditional_t<std::is_same<T, float>::value, float, double>;
+
+// Newton iteration for constant evaluation, where std::sqrt is not constexpr
+template <typename D>
+constexpr D constexprSqrt(D v) {
+    if (!(v > 0)) {
+        return D(0);
+    }
+    D r = v > 1 ? v : D(1);
+    for (;;) {
+        D next = (r + v / r) / 2;
+        if (!(next < r)) {
+            return r;
+        }
+        r = next;
+    }
+}
+
+template <typename D>
+constexpr D sqrt(D v) {
+#if defined(__cpp_lib_is_constant_evaluated)
+    if (!std::is_constant_evaluated()) return std::sqrt(v);
+#elif defined(__GNUC__) || defined(__clang__)
+    if (!__builtin_is_constant_evaluated()) return std::sqrt(v);
+#endif
+    return constexprSqrt(v);
+}
+
+// a + (b - a) / 2: never forms a + b, and integer coordinates take the
+// difference in 64 bits so it cannot overflow either
+template <typename T>
+constexpr T halfway(T a, T b) {
+    if constexpr (std::is_integral<T>::value) {
+        return static_cast<T>(a + (static_cast<std::int64_t>(b) - a) / 2);
+    } else {
+        return a + (b - a) / 2;
+    }
+}
+
+constexpr Fixed16 halfway(Fixed16 a, Fixed16 b) {
+    return Fixed16::fromRaw(halfway(a.raw(), b.raw()));
+}
+
+} // namespace detail
+
 // Nonmember function in the same namespace - part of Point's interface
-double distance(const Point& p1, const Point& p2) {
-    double dx = p1.x() - p2.x();
-    double dy = p1.y() - p2.y();
-    return std::sqrt(dx * dx + dy * dy);
+template <typename T>
+constexpr detail::distance_t<T> distance(const BasicPoint<T>& p1, const BasicPoint<T>& p2) {
+    using D = detail::distance_t<T>;
+    D dx = static_cast<D>(p1.x()) - static_cast<D>(p2.x());
+    D dy = static_cast<D>(p1.y()) - static_cast<D>(p2.y());
+    return detail::sqrt(dx * dx + dy * dy);
 }
 
 // Another nonmember function in the same namespace
-Point midpoint(const Point& p1, const Point& p2) {
-    return Point((p1.x() + p2.x()) / 2.0,
-                 (p1.y() + p2.y()) / 2.0);
+template <typename T>
+constexpr BasicPoint<T> midpoint(const BasicPoint<T>& p1, const BasicPoint<T>& p2) {
+    return BasicPoint<T>(detail::halfway(p1.x(), p2.x()),
+                         detail::halfway(p1.y(), p2.y()));
 }
 
 // Output operator - part of the interface
-std::ostream& operator<<(std::ostream& os, const Point& p) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const BasicPoint<T>& p) {
     return os << "(" << p.x() << ", " << p.y() << ")";
 }
 
+// Explicit instantiations for the supported coordinate precisions
+#define GEOMETRY_INSTANTIATE_POINT(T)                                                   \
+    template class BasicPoint<T>;                                                     \
+    template detail::distance_t<T> distance(const BasicPoint<T>&, const BasicPoint<T>&); \
+    template BasicPoint<T> midpoint(const BasicPoint<T>&, const BasicPoint<T>&);      \
+    template std::ostream& operator<<(std::ostream&, const BasicPoint<T>&);
+
+GEOMETRY_INSTANTIATE_POINT(float)
+GEOMETRY_INSTANTIATE_POINT(double)
+GEOMETRY_INSTANTIATE_POINT(std::int32_t)
+GEOMETRY_INSTANTIATE_POINT(Fixed16)
+
+#undef GEOMETRY_INSTANTIATE_POINT
+
 } // namespace geometry
 
 int main() {
@@ -47,5 +165,24 @@ int main() {
     // operator<< also benefits from ADL
     std::cout << "Point 1: " << p1 << "\n";
 
+    // The same interface is found by ADL for every precision, at compile time too
+    constexpr geometry::BasicPoint<std::int32_t> g1(0, 0), g2(6, 8);
+    static_assert(distance(g1, g2) == 10.0, "constexpr distance");
+    static_assert(midpoint(g1, g2).x() == 3, "constexpr midpoint");
+
+    // Neither the int32 midpoint nor the Q16.16 conversion overflows near the range limits
+    constexpr geometry::BasicPoint<std::int32_t> big1(INT32_MAX, INT32_MIN), big2(INT32_MAX - 2, INT32_MAX);
+    static_assert(midpoint(big1, big2).x() == INT32_MAX - 1, "int32 midpoint without overflow");
+    static_assert(midpoint(big1, big2).y() == -1, "int32 midpoint without overflow");
+    static_assert(geometry::Fixed16(40000).raw() == INT32_MAX, "Q16.16 saturates");
+    static_assert(geometry::Fixed16(-1e9).raw() == INT32_MIN, "Q16.16 saturates");
+
+    geometry::BasicPoint<float> f1(0.0f, 0.0f), f2(3.0f, 4.0f);
+    geometry::BasicPoint<geometry::Fixed16> q1(geometry::Fixed16(0.5), geometry::Fixed16(1.5));
+    geometry::BasicPoint<geometry::Fixed16> q2(geometry::Fixed16(3.5), geometry::Fixed16(5.5));
+    std::cout << "float:   " << distance(f1, f2) << " between " << f1 << " and " << f2 << "\n";
+    std::cout << "int32:   " << distance(g1, g2) << ", midpoint " << midpoint(g1, g2) << "\n";
+    std::cout << "Q16.16:  " << distance(q1, q2) << ", midpoint " << midpoint(q1, q2) << "\n";
+
     return 0;
 }
@@ -0,0 +1,326 @@
+// Good: A spatial index that is part of Point's interface lives in namespace geometry
+// Brute-force nearest-point search calls geometry::distance against every stored
+// Point - O(n) per query. KdTree answers the same questions in O(log n) on average.
+//
+// Layout: an implicit, balanced tree over one flat array. The node for a range
+// [lo, hi) is the median element at mid = (lo + hi) / 2; its children are the
+// ranges [lo, mid) and [mid + 1, hi). There are no node objects and no per-node
+// heap allocations - just the reordered points, their original indices and one
+// split-axis byte per element.
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+double distance(const Point& p1, const Point& p2) {
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Queries compare squared distances and only take the root of what they return
+double squaredDistance(const Point& p1, const Point& p2) {
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return dx * dx + dy * dy;
+}
+
+// A query result: index into the span the tree was built from, and its distance
+struct Neighbor {
+    std::size_t index;
+    double distance;
+};
+
+class KdTree {
+private:
+    std::vector<Point> points_;         // reordered into implicit-tree order
+    std::vector<std::size_t> ids_;      // original index of points_[i]
+    std::vector<std::uint8_t> axis_;    // split axis of the node at i (0 = x, 1 = y)
+
+    static double coord(const Point& p, int axis) { return axis == 0 ? p.x() : p.y(); }
+
+    // Below this many points a subtree is built on the calling thread
+    static constexpr std::size_t parallelCutoff = 1 << 15;
+
+    void build(const Point* src, std::size_t lo, std::size_t hi, int spawnDepth);
+
+    void nearest(std::size_t lo, std::size_t hi, const Point& q,
+                 std::size_t& best, double& bestD2) const;
+
+    using MaxHeap = std::priority_queue<std::pair<double, std::size_t>>;
+    void kNearest(std::size_t lo, std::size_t hi, const Point& q,
+                  std::size_t k, MaxHeap& heap) const;
+
+    void radius(std::size_t lo, std::size_t hi, const Point& q, double r2,
+                std::vector<Neighbor>& out) const;
+
+public:
+    // Builds from points[0, count); bulk build splits across threads
+    KdTree(const Point* points, std::size_t count);
+    explicit KdTree(const std::vector<Point>& points) : KdTree(points.data(), points.size()) {}
+
+    std::size_t size() const { return points_.size(); }
+    bool empty() const { return points_.empty(); }
+
+    friend Neighbor nearest(const KdTree& tree, const Point& query);
+    friend std::vector<Neighbor> k_nearest(const KdTree& tree, const Point& query, std::size_t k);
+    friend std::vector<Neighbor> radius_query(const KdTree& tree, const Point& query, double r);
+};
+
+KdTree::KdTree(const Point* points, std::size_t count)
+    : ids_(count), axis_(count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        ids_[i] = i;
+    }
+
+    // Spawn roughly one task per hardware thread at the top of the tree
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int spawnDepth = 0;
+    while ((1u << spawnDepth) < threads) {
+        ++spawnDepth;
+    }
+    build(points, 0, count, spawnDepth);
+
+    points_.reserve(count);
+    for (std::size_t id : ids_) {
+        points_.push_back(points[id]);
+    }
+}
+
+void KdTree::build(const Point* src, std::size_t lo, std::size_t hi, int spawnDepth) {
+    if (hi - lo <= 1) {
+        return;
+    }
+
+    // Split on the wider extent of this range
+    double minX = std::numeric_limits<double>::max(), maxX = -minX;
+    double minY = minX, maxY = -minX;
+    for (std::size_t i = lo; i < hi; ++i) {
+        const Point& p = src[ids_[i]];
+        minX = std::min(minX, p.x()); maxX = std::max(maxX, p.x());
+        minY = std::min(minY, p.y()); maxY = std::max(maxY, p.y());
+    }
+    const int axis = (maxX - minX >= maxY - minY) ? 0 : 1;
+    const std::size_t mid = lo + (hi - lo) / 2;
+
+    // Partition the index range only; points_ is gathered once the tree is built
+    std::nth_element(ids_.begin() + lo, ids_.begin() + mid, ids_.begin() + hi,
+                     [src, axis](std::size_t a, std::size_t b) {
+                         return coord(src[a], axis) < coord(src[b], axis);
+                     });
+    axis_[mid] = static_cast<std::uint8_t>(axis);
+
+    // Children touch disjoint ranges, so they can be built concurrently
+    if (spawnDepth > 0 && hi - lo > parallelCutoff) {
+        auto left = std::async(std::launch::async,
+                               [=] { build(src, lo, mid, spawnDepth - 1); });
+        build(src, mid + 1, hi, spawnDepth - 1);
+        left.get();
+    } else {
+        build(src, lo, mid, 0);
+        build(src, mid + 1, hi, 0);
+    }
+}
+
+void KdTree::nearest(std::size_t lo, std::size_t hi, const Point& q,
+                     std::size_t& best, double& bestD2) const {
+    if (lo >= hi) {
+        return;
+    }
+    const std::size_t mid = lo + (hi - lo) / 2;
+    const double d2 = squaredDistance(points_[mid], q);
+    if (d2 < bestD2) {
+        bestD2 = d2;
+        best = mid;
+    }
+
+    const int axis = axis_[mid];
+    const double delta = coord(q, axis) - coord(points_[mid], axis);
+    // Descend into the side containing q first; visit the other only if it can win
+    if (delta < 0) {
+        nearest(lo, mid, q, best, bestD2);
+        if (delta * delta < bestD2) nearest(mid + 1, hi, q, best, bestD2);
+    } else {
+        nearest(mid + 1, hi, q, best, bestD2);
+        if (delta * delta < bestD2) nearest(lo, mid, q, best, bestD2);
+    }
+}
+
+void KdTree::kNearest(std::size_t lo, std::size_t hi, const Point& q,
+                      std::size_t k, MaxHeap& heap) const {
+    if (lo >= hi) {
+        return;
+    }
+    const std::size_t mid = lo + (hi - lo) / 2;
+    const double d2 = squaredDistance(points_[mid], q);
+    if (heap.size() < k) {
+        heap.emplace(d2, mid);
+    } else if (d2 < heap.top().first) {
+        heap.pop();
+        heap.emplace(d2, mid);
+    }
+
+    const int axis = axis_[mid];
+    const double delta = coord(q, axis) - coord(points_[mid], axis);
+    const std::size_t nearLo = delta < 0 ? lo : mid + 1, nearHi = delta < 0 ? mid : hi;
+    const std::size_t farLo = delta < 0 ? mid + 1 : lo, farHi = delta < 0 ? hi : mid;
+    kNearest(nearLo, nearHi, q, k, heap);
+    if (heap.size() < k || delta * delta < heap.top().first) {
+        kNearest(farLo, farHi, q, k, heap);
+    }
+}
+
+void KdTree::radius(std::size_t lo, std::size_t hi, const Point& q, double r2,
+                    std::vector<Neighbor>& out) const {
+    if (lo >= hi) {
+        return;
+    }
+    const std::size_t mid = lo + (hi - lo) / 2;
+    const double d2 = squaredDistance(points_[mid], q);
+    if (d2 <= r2) {
+        out.push_back({mid, d2});  // squared for now; fixed up by radius_query
+    }
+
+    const int axis = axis_[mid];
+    const double delta = coord(q, axis) - coord(points_[mid], axis);
+    if (delta <= 0 || delta * delta <= r2) radius(lo, mid, q, r2, out);
+    if (delta >= 0 || delta * delta <= r2) radius(mid + 1, hi, q, r2, out);
+}
+
+// ============================================================================
+// Query interface - nonmember functions in namespace geometry (found via ADL)
+// ============================================================================
+
+// Closest stored point; index is SIZE_MAX for an empty tree
+Neighbor nearest(const KdTree& tree, const Point& query) {
+    std::size_t best = 0;
+    double bestD2 = std::numeric_limits<double>::infinity();
+    tree.nearest(0, tree.size(), query, best, bestD2);
+    if (tree.empty()) {
+        return {std::numeric_limits<std::size_t>::max(), bestD2};
+    }
+    return {tree.ids_[best], std::sqrt(bestD2)};
+}
+
+// Up to k closest stored points, nearest first
+std::vector<Neighbor> k_nearest(const KdTree& tree, const Point& query, std::size_t k) {
+    std::vector<Neighbor> result;
+    if (k == 0) {
+        return result;
+    }
+    KdTree::MaxHeap heap;
+    tree.kNearest(0, tree.size(), query, k, heap);
+
+    result.resize(heap.size());
+    for (std::size_t i = heap.size(); i-- > 0; heap.pop()) {
+        result[i] = {tree.ids_[heap.top().second], std::sqrt(heap.top().first)};
+    }
+    return result;
+}
+
+// All stored points within distance r of query, in no particular order
+std::vector<Neighbor> radius_query(const KdTree& tree, const Point& query, double r) {
+    std::vector<Neighbor> result;
+    tree.radius(0, tree.size(), query, r * r, result);
+    for (Neighbor& n : result) {
+        n.index = tree.ids_[n.index];
+        n.distance = std::sqrt(n.distance);
+    }
+    return result;
+}
+
+} // namespace geometry
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    const int queries = 200;
+
+    std::mt19937 rng(57);
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    std::vector<geometry::Point> points;
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        points.emplace_back(coord(rng), coord(rng));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    geometry::KdTree tree(points);
+    auto t1 = Clock::now();
+    std::cout << "Built k-d tree over " << tree.size() << " points in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+
+    std::vector<geometry::Point> qs;
+    for (int i = 0; i < queries; ++i) {
+        qs.emplace_back(coord(rng), coord(rng));
+    }
+
+    // Brute force: geometry::distance against every stored point
+    auto t2 = Clock::now();
+    std::vector<std::size_t> bruteIdx;
+    for (const auto& q : qs) {
+        std::size_t best = 0;
+        double bestD = std::numeric_limits<double>::max();
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            double d = distance(points[i], q);
+            if (d < bestD) { bestD = d; best = i; }
+        }
+        bruteIdx.push_back(best);
+    }
+    auto t3 = Clock::now();
+
+    int mismatches = 0;
+    for (int i = 0; i < queries; ++i) {
+        geometry::Neighbor nb = nearest(tree, qs[i]);  // ADL
+        if (distance(points[nb.index], qs[i]) != distance(points[bruteIdx[i]], qs[i])) {
+            ++mismatches;
+        }
+    }
+    auto t4 = Clock::now();
+
+    std::cout << queries << " nearest queries: brute force "
+              << std::chrono::duration<double, std::milli>(t3 - t2).count() << " ms, k-d tree "
+              << std::chrono::duration<double, std::milli>(t4 - t3).count() << " ms, "
+              << mismatches << " mismatches\n";
+
+    geometry::Point q(500, 500);
+    auto knn = k_nearest(tree, q, 5);
+    std::cout << "5 nearest to (500, 500):";
+    for (const auto& nb : knn) {
+        std::cout << " #" << nb.index << "@" << nb.distance;
+    }
+    std::cout << "\n";
+
+    auto inRange = radius_query(tree, q, 10.0);
+    std::size_t bruteInRange = 0;
+    for (const auto& p : points) {
+        if (distance(p, q) <= 10.0) ++bruteInRange;
+    }
+    std::cout << "Points within 10 of (500, 500): " << inRange.size()
+              << " (brute force: " << bruteInRange << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,431 @@
+// Good: Batch (structure-of-arrays) interface kept in the same namespace as the type
+// geometry::distance on one Point pair is fine for a handful of calls, but a
+// scoring loop that runs millions of times per frame wants the coordinates laid
+// out as separate x[] / y[] columns so the compiler and SIMD units can stream them.
+// The batch overloads still live in namespace geometry, so ADL finds them exactly
+// like the single-pair version.
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <limits>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_HAS_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define GEOMETRY_HAS_X86_SIMD 0
+#endif
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+double distance(const Point& p1, const Point& p2) {
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// ============================================================================
+// PointCloud: structure-of-arrays storage, 64-byte aligned columns
+// ============================================================================
+
+// Minimal allocator so std::vector hands out cache-line aligned columns
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+class PointCloud {
+public:
+    static constexpr std::size_t alignment = 64;
+    using Column = std::vector<float, AlignedAllocator<float, alignment>>;
+
+private:
+    Column x_, y_;
+
+public:
+    PointCloud() = default;
+    explicit PointCloud(std::size_t capacity) { reserve(capacity); }
+
+    void reserve(std::size_t n) { x_.reserve(n); y_.reserve(n); }
+    void push_back(const Point& p) {
+        x_.push_back(static_cast<float>(p.x()));
+        y_.push_back(static_cast<float>(p.y()));
+    }
+
+    std::size_t size() const { return x_.size(); }
+    bool empty() const { return x_.empty(); }
+
+    const float* xs() const { return x_.data(); }
+    const float* ys() const { return y_.data(); }
+
+    Point operator[](std::size_t i) const { return Point(x_[i], y_[i]); }
+};
+
+// ============================================================================
+// Kernels: scalar fallback plus SSE / AVX2, selected once at runtime
+// ============================================================================
+
+namespace detail {
+
+// out[i] = |(xs[i], ys[i]) - (px, py)|
+using ToPointKernel = void (*)(const float*, const float*, float, float, float*, std::size_t);
+// out[i] = |(ax[i], ay[i]) - (bx[i], by[i])|
+using PairwiseKernel = void (*)(const float*, const float*, const float*, const float*,
+                                float*, std::size_t);
+// Index of the first point with the smallest squared distance to (px, py); n > 0.
+// Squared distance orders points the same way as distance, so no sqrt is taken.
+using NearestKernel = std::size_t (*)(const float*, const float*, float, float, std::size_t);
+
+void toPointScalar(const float* xs, const float* ys, float px, float py,
+                   float* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        float dx = xs[i] - px;
+        float dy = ys[i] - py;
+        out[i] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+void pairwiseScalar(const float* ax, const float* ay, const float* bx, const float* by,
+                    float* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        float dx = ax[i] - bx[i];
+        float dy = ay[i] - by[i];
+        out[i] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+std::size_t nearestScalar(const float* xs, const float* ys, float px, float py, std::size_t n) {
+    std::size_t best = 0;
+    float bestD2 = std::numeric_limits<float>::infinity();
+    for (std::size_t i = 0; i < n; ++i) {
+        float dx = xs[i] - px;
+        float dy = ys[i] - py;
+        float d2 = dx * dx + dy * dy;
+        if (d2 < bestD2) { bestD2 = d2; best = i; }
+    }
+    return best;
+}
+
+// Folds the per-lane winners (lane j saw indices congruent to j) and the
+// scalar tail [from, n) into one index; ties go to the lower index, as in
+// nearestScalar
+std::size_t reduceNearest(const float* laneD2, const std::int32_t* laneIdx, std::size_t lanes,
+                          const float* xs, const float* ys, float px, float py,
+                          std::size_t from, std::size_t n) {
+    std::size_t best = 0;
+    float bestD2 = std::numeric_limits<float>::infinity();
+    for (std::size_t j = 0; j < lanes; ++j) {
+        const std::size_t idx = static_cast<std::size_t>(laneIdx[j]);
+        if (laneD2[j] < bestD2 || (laneD2[j] == bestD2 && idx < best)) {
+            bestD2 = laneD2[j];
+            best = idx;
+        }
+    }
+    for (std::size_t i = from; i < n; ++i) {
+        float dx = xs[i] - px;
+        float dy = ys[i] - py;
+        float d2 = dx * dx + dy * dy;
+        if (d2 < bestD2) { bestD2 = d2; best = i; }
+    }
+    return best;
+}
+
+#if GEOMETRY_HAS_X86_SIMD
+__attribute__((target("sse2")))
+void toPointSse(const float* xs, const float* ys, float px, float py,
+                float* out, std::size_t n) {
+    const __m128 vpx = _mm_set1_ps(px);
+    const __m128 vpy = _mm_set1_ps(py);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), vpx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), vpy);
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        _mm_storeu_ps(out + i, _mm_sqrt_ps(d2));
+    }
+    toPointScalar(xs + i, ys + i, px, py, out + i, n - i);
+}
+
+__attribute__((target("sse2")))
+void pairwiseSse(const float* ax, const float* ay, const float* bx, const float* by,
+                 float* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i));
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        _mm_storeu_ps(out + i, _mm_sqrt_ps(d2));
+    }
+    pairwiseScalar(ax + i, ay + i, bx + i, by + i, out + i, n - i);
+}
+
+// Lane indices are int32, which covers clouds of up to 2^31 - 1 points
+__attribute__((target("sse2")))
+std::size_t nearestSse(const float* xs, const float* ys, float px, float py, std::size_t n) {
+    const __m128 vpx = _mm_set1_ps(px);
+    const __m128 vpy = _mm_set1_ps(py);
+    __m128 bestD2 = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128i bestIdx = _mm_setzero_si128();
+    __m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i step = _mm_set1_epi32(4);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), vpx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), vpy);
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 closer = _mm_cmplt_ps(d2, bestD2);
+        bestD2 = _mm_min_ps(d2, bestD2);
+        __m128i mask = _mm_castps_si128(closer);
+        bestIdx = _mm_or_si128(_mm_and_si128(mask, idx), _mm_andnot_si128(mask, bestIdx));
+        idx = _mm_add_epi32(idx, step);
+    }
+    alignas(16) float laneD2[4];
+    alignas(16) std::int32_t laneIdx[4];
+    _mm_store_ps(laneD2, bestD2);
+    _mm_store_si128(reinterpret_cast<__m128i*>(laneIdx), bestIdx);
+    return reduceNearest(laneD2, laneIdx, 4, xs, ys, px, py, i, n);
+}
+
+__attribute__((target("avx2,fma")))
+void toPointAvx2(const float* xs, const float* ys, float px, float py,
+                 float* out, std::size_t n) {
+    const __m256 vpx = _mm256_set1_ps(px);
+    const __m256 vpy = _mm256_set1_ps(py);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vpx);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vpy);
+        __m256 d2 = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(d2));
+    }
+    toPointScalar(xs + i, ys + i, px, py, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+void pairwiseAvx2(const float* ax, const float* ay, const float* bx, const float* by,
+                  float* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(ax + i), _mm256_loadu_ps(bx + i));
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ay + i), _mm256_loadu_ps(by + i));
+        __m256 d2 = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(d2));
+    }
+    pairwiseScalar(ax + i, ay + i, bx + i, by + i, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+std::size_t nearestAvx2(const float* xs, const float* ys, float px, float py, std::size_t n) {
+    const __m256 vpx = _mm256_set1_ps(px);
+    const __m256 vpy = _mm256_set1_ps(py);
+    __m256 bestD2 = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    __m256i bestIdx = _mm256_setzero_si256();
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vpx);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vpy);
+        __m256 d2 = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+        __m256 closer = _mm256_cmp_ps(d2, bestD2, _CMP_LT_OQ);
+        bestD2 = _mm256_min_ps(d2, bestD2);
+        bestIdx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIdx),
+                                                       _mm256_castsi256_ps(idx), closer));
+        idx = _mm256_add_epi32(idx, step);
+    }
+    alignas(32) float laneD2[8];
+    alignas(32) std::int32_t laneIdx[8];
+    _mm256_store_ps(laneD2, bestD2);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(laneIdx), bestIdx);
+    return reduceNearest(laneD2, laneIdx, 8, xs, ys, px, py, i, n);
+}
+#endif
+
+struct Kernels {
+    ToPointKernel toPoint;
+    PairwiseKernel pairwise;
+    NearestKernel nearest;
+    const char* name;
+};
+
+Kernels selectKernels() {
+#if GEOMETRY_HAS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {toPointAvx2, pairwiseAvx2, nearestAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {toPointSse, pairwiseSse, nearestSse, "sse2"};
+    }
+#endif
+    return {toPointScalar, pairwiseScalar, nearestScalar, "scalar"};
+}
+
+// Chosen once, on first use
+const Kernels& kernels() {
+    static const Kernels k = selectKernels();
+    return k;
+}
+
+} // namespace detail
+
+// ============================================================================
+// Batch interface - same namespace as Point and PointCloud, so ADL finds it
+// ============================================================================
+
+// out must hold cloud.size() floats
+void distance(const PointCloud& cloud, const Point& p, float* out) {
+    detail::kernels().toPoint(cloud.xs(), cloud.ys(),
+                              static_cast<float>(p.x()), static_cast<float>(p.y()),
+                              out, cloud.size());
+}
+
+// Element-wise: out[i] = distance(a[i], b[i]); both clouds must have the same size
+void distance(const PointCloud& a, const PointCloud& b, float* out) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("distance: point clouds differ in size");
+    }
+    detail::kernels().pairwise(a.xs(), a.ys(), b.xs(), b.ys(), out, a.size());
+}
+
+// Index of the cloud point closest to p (the nearest-point scoring loop).
+// One pass: the kernel keeps a running min/argmin per lane instead of writing
+// n distances out and scanning them again.
+std::size_t nearest(const PointCloud& cloud, const Point& p) {
+    if (cloud.empty()) {
+        throw std::invalid_argument("nearest: empty point cloud");
+    }
+    if (cloud.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+        throw std::length_error("nearest: point cloud too large for 32-bit lane indices");
+    }
+    return detail::kernels().nearest(cloud.xs(), cloud.ys(),
+                                     static_cast<float>(p.x()), static_cast<float>(p.y()),
+                                     cloud.size());
+}
+
+} // namespace geometry
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int queries = 20;
+
+    std::mt19937 rng(57);
+    std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+    // Float-representable coordinates, so the double AoS path and the float
+    // columns see exactly the same points
+    auto fcoord = [&] { return static_cast<double>(static_cast<float>(coord(rng))); };
+
+    std::vector<geometry::Point> points;
+    geometry::PointCloud cloud(n);
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        geometry::Point p(fcoord(), fcoord());
+        points.push_back(p);
+        cloud.push_back(p);
+    }
+
+    std::cout << "Kernel selected at runtime: " << geometry::detail::kernels().name << "\n";
+
+    // Check the SIMD kernel against the scalar reference
+    std::vector<float> simd(n), ref(n);
+    geometry::Point q(12.5, -7.25);
+    distance(cloud, q, simd.data());  // ADL: argument types live in geometry
+    geometry::detail::toPointScalar(cloud.xs(), cloud.ys(), 12.5f, -7.25f, ref.data(), n);
+    float maxErr = 0.0f;
+    for (std::size_t i = 0; i < n; ++i) {
+        maxErr = std::max(maxErr, std::fabs(simd[i] - ref[i]));
+    }
+    std::cout << "Max |simd - scalar| = " << maxErr << "\n";
+
+    std::vector<float> pairwise(n);
+    distance(cloud, cloud, pairwise.data());
+    std::cout << "Self pairwise distance [0] = " << pairwise[0] << "\n";
+
+    // Nearest-point scoring: one Point pair at a time vs. the batch kernel,
+    // over the same queries
+    std::vector<geometry::Point> queryPoints;
+    for (int k = 0; k < queries; ++k) queryPoints.emplace_back(fcoord(), fcoord());
+
+    using Clock = std::chrono::steady_clock;
+
+    auto t0 = Clock::now();
+    std::vector<std::size_t> aosBest;
+    for (const geometry::Point& query : queryPoints) {
+        std::size_t best = 0;
+        double bestDist = std::numeric_limits<double>::max();
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            double d = distance(points[i], query);
+            if (d < bestDist) { bestDist = d; best = i; }
+        }
+        aosBest.push_back(best);
+    }
+    auto t1 = Clock::now();
+
+    std::vector<std::size_t> soaBest;
+    for (const geometry::Point& query : queryPoints) {
+        soaBest.push_back(nearest(cloud, query));
+    }
+    auto t2 = Clock::now();
+
+    // float d^2 can round two near-equidistant points together where double
+    // sqrt keeps them apart, so a mismatch is only a failure if it is not a tie
+    int mismatches = 0;
+    for (int k = 0; k < queries; ++k) {
+        if (soaBest[k] == aosBest[k]) continue;
+        const double da = distance(points[aosBest[k]], queryPoints[k]);
+        const double ds = distance(points[soaBest[k]], queryPoints[k]);
+        if (std::fabs(da - ds) > 1e-3 * std::max(1.0, da)) ++mismatches;
+    }
+    const std::size_t scalarBest = geometry::detail::nearestScalar(cloud.xs(), cloud.ys(), 12.5f, -7.25f, n);
+
+    double aosMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    double soaMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    std::cout << queries << " nearest-point queries over " << n << " points\n";
+    std::cout << "  AoS, one pair per call: " << aosMs << " ms\n";
+    std::cout << "  SoA fused argmin:       " << soaMs << " ms"
+              << " (" << (soaMs > 0 ? aosMs / soaMs : 0.0) << "x)\n";
+    const bool kernelOk = nearest(cloud, q) == scalarBest;
+    std::cout << "  same nearest point: " << (mismatches == 0 ? "yes" : "NO")
+              << ", kernel matches scalar: " << (kernelOk ? "yes" : "NO") << "\n";
+
+    return (mismatches == 0 && kernelOk) ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+// Good: A fast text formatter for Point, offered alongside operator<< in namespace geometry
+// operator<<(std::ostream&, const Point&) goes through the stream's locale and
+// num_put facets for every coordinate. format_to writes straight into a caller
+// buffer with std::to_chars - no allocation, no locale, no virtual calls - and
+// write_points batches many formatted points into one write() per buffer.
+//
+// FormatMode::shortest prints the shortest text that parses back to the same
+// double. FormatMode::ostreamCompatible matches the default stream output
+// (printf "%g", precision 6) byte for byte, so existing dumps can be diffed.
+
+#include <iostream>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+std::ostream& operator<<(std::ostream& os, const Point& p) {
+    return os << "(" << p.x() << ", " << p.y() << ")";
+}
+
+enum class FormatMode {
+    shortest,            // round-trip exact, shortest representation
+    ostreamCompatible,   // identical to operator<< on a default-configured stream
+};
+
+// Upper bound on what format_to writes for one point: two 24-char doubles plus "(, )"
+constexpr std::size_t maxFormattedPointSize = 64;
+
+namespace detail {
+
+char* formatCoordinate(char* first, double v, FormatMode mode) {
+    char* last = first + 32;
+    std::to_chars_result r = (mode == FormatMode::shortest)
+        ? std::to_chars(first, last, v)
+        : std::to_chars(first, last, v, std::chars_format::general, 6);
+    return r.ptr;
+}
+
+} // namespace detail
+
+// Writes "(x, y)" to buf, which must have room for maxFormattedPointSize chars.
+// Returns one past the last character written; no terminator is added.
+char* format_to(char* buf, const Point& p, FormatMode mode = FormatMode::shortest) {
+    char* out = buf;
+    *out++ = '(';
+    out = detail::formatCoordinate(out, p.x(), mode);
+    *out++ = ',';
+    *out++ = ' ';
+    out = detail::formatCoordinate(out, p.y(), mode);
+    *out++ = ')';
+    return out;
+}
+
+std::string to_string(const Point& p, FormatMode mode = FormatMode::shortest) {
+    char buf[maxFormattedPointSize];
+    return std::string(buf, format_to(buf, p, mode));
+}
+
+namespace detail {
+
+void writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw std::system_error(errno, std::generic_category(), "write_points");
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+} // namespace detail
+
+// Formats points[0, n) one per line into a 64 KiB buffer, issuing one write()
+// each time it fills. Throws std::system_error if the descriptor rejects a write.
+void write_points(int fd, const Point* points, std::size_t n,
+                  FormatMode mode = FormatMode::shortest) {
+    constexpr std::size_t bufferSize = 1 << 16;
+    std::vector<char> buffer(bufferSize);
+    char* const begin = buffer.data();
+    char* const flushAt = begin + bufferSize - (maxFormattedPointSize + 1);
+
+    char* out = begin;
+    for (std::size_t i = 0; i < n; ++i) {
+        out = format_to(out, points[i], mode);
+        *out++ = '\n';
+        if (out >= flushAt) {
+            detail::writeAll(fd, begin, static_cast<std::size_t>(out - begin));
+            out = begin;
+        }
+    }
+    detail::writeAll(fd, begin, static_cast<std::size_t>(out - begin));
+}
+
+void write_points(int fd, const std::vector<Point>& points, FormatMode mode = FormatMode::shortest) {
+    write_points(fd, points.data(), points.size(), mode);
+}
+
+} // namespace geometry
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    std::mt19937 rng(57);
+    std::uniform_real_distribution<double> coord(-1e4, 1e4);
+    std::vector<geometry::Point> points;
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        points.emplace_back(coord(rng), coord(rng));
+    }
+    points.emplace_back(0.1, 1e-300);
+    points.emplace_back(3, 4);
+
+    // Compatibility mode must reproduce operator<< exactly
+    std::size_t mismatches = 0;
+    for (const auto& p : points) {
+        std::ostringstream os;
+        os << p;
+        if (os.str() != to_string(p, geometry::FormatMode::ostreamCompatible)) ++mismatches;
+    }
+    std::cout << "ostreamCompatible mismatches vs operator<<: " << mismatches << "\n";
+
+    // Shortest mode must round-trip
+    std::size_t roundTripFailures = 0;
+    for (const auto& p : points) {
+        std::string s = to_string(p);
+        double x = 0, y = 0;
+        const char* sep = s.c_str() + s.find(", ");
+        std::from_chars(s.c_str() + 1, sep, x);
+        std::from_chars(sep + 2, s.c_str() + s.size() - 1, y);
+        if (x != p.x() || y != p.y()) ++roundTripFailures;
+    }
+    std::cout << "shortest round-trip failures: " << roundTripFailures
+              << " (e.g. " << to_string(points[0]) << " vs " << points[0] << ")\n";
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    std::ostringstream sink;
+    auto t0 = Clock::now();
+    for (const auto& p : points) sink << p << "\n";
+    auto t1 = Clock::now();
+
+    std::vector<char> buffer(points.size() * (geometry::maxFormattedPointSize + 1));
+    char* out = buffer.data();
+    for (const auto& p : points) {
+        out = format_to(out, p, geometry::FormatMode::ostreamCompatible);
+        *out++ = '\n';
+    }
+    auto t2 = Clock::now();
+
+    int devNull = ::open("/dev/null", O_WRONLY);
+    write_points(devNull, points);
+    ::close(devNull);
+    auto t3 = Clock::now();
+
+    std::cout << points.size() << " points\n";
+    std::cout << "  operator<< into ostringstream:  " << ms(t1 - t0) << " ms\n";
+    std::cout << "  format_to (ostreamCompatible):  " << ms(t2 - t1) << " ms, identical output: "
+              << (sink.str() == std::string(buffer.data(), out) ? "yes" : "no") << "\n";
+    std::cout << "  write_points (shortest) to fd:  " << ms(t3 - t2) << " ms\n";
+
+    return 0;
+}
@@ -0,0 +1,337 @@
+// Good: Polyline operations on point sequences as part of Point's interface in namespace geometry
+// Tracks are stored as std::vector<Point>.
+//   path_length: segment lengths two (SSE2) or four (AVX2) at a time with one
+//                packed sqrt, chosen at runtime; the scalar fallback keeps four
+//                independent accumulators so it is not serialized on one add chain.
+//   simplify:    Douglas-Peucker with an explicit stack of index ranges (no
+//                recursion, so very long tracks cannot overflow the call
+//                stack), comparing squared distances against tolerance^2.
+//   simplify_tracks: many independent tracks, one task per track, spread over
+//                threads.
+// Each call reports how many points it removed and how long it took, so the
+// tolerance can be tuned against latency.
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_HAS_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define GEOMETRY_HAS_X86_SIMD 0
+#endif
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+double distance(const Point& p1, const Point& p2) {
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// The path_length kernels read a Point array as interleaved doubles
+static_assert(sizeof(Point) == 2 * sizeof(double) && std::is_standard_layout<Point>::value,
+              "Point must be two packed doubles");
+
+namespace detail {
+
+// Sum of |p[i + 1] - p[i]| over the n interleaved points xy[0, 2n); n >= 2
+using LengthKernel = double (*)(const double*, std::size_t);
+
+double lengthScalar(const double* xy, std::size_t n) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    std::size_t i = 0;
+    for (; i + 4 < n; i += 4) {
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            const double dx = xy[2 * (i + lane) + 2] - xy[2 * (i + lane)];
+            const double dy = xy[2 * (i + lane) + 3] - xy[2 * (i + lane) + 1];
+            acc[lane] += std::sqrt(dx * dx + dy * dy);
+        }
+    }
+    for (; i + 1 < n; ++i) {
+        const double dx = xy[2 * i + 2] - xy[2 * i], dy = xy[2 * i + 3] - xy[2 * i + 1];
+        acc[0] += std::sqrt(dx * dx + dy * dy);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+#if GEOMETRY_HAS_X86_SIMD
+// Two segments per step: [dx0 dy0], [dx1 dy1] -> [dx0^2 + dy0^2, dx1^2 + dy1^2]
+__attribute__((target("sse2")))
+double lengthSse2(const double* xy, std::size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 < n; i += 4) {
+        const __m128d p0 = _mm_loadu_pd(xy + 2 * i), p1 = _mm_loadu_pd(xy + 2 * i + 2);
+        const __m128d p2 = _mm_loadu_pd(xy + 2 * i + 4), p3 = _mm_loadu_pd(xy + 2 * i + 6);
+        const __m128d p4 = _mm_loadu_pd(xy + 2 * i + 8);
+        __m128d d0 = _mm_sub_pd(p1, p0), d1 = _mm_sub_pd(p2, p1);
+        __m128d d2 = _mm_sub_pd(p3, p2), d3 = _mm_sub_pd(p4, p3);
+        d0 = _mm_mul_pd(d0, d0); d1 = _mm_mul_pd(d1, d1);
+        d2 = _mm_mul_pd(d2, d2); d3 = _mm_mul_pd(d3, d3);
+        acc0 = _mm_add_pd(acc0, _mm_sqrt_pd(_mm_add_pd(_mm_unpacklo_pd(d0, d1), _mm_unpackhi_pd(d0, d1))));
+        acc1 = _mm_add_pd(acc1, _mm_sqrt_pd(_mm_add_pd(_mm_unpacklo_pd(d2, d3), _mm_unpackhi_pd(d2, d3))));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (i + 1 < n ? lengthScalar(xy + 2 * i, n - i) : 0.0);
+}
+
+// Four segments per step: hadd of the squared deltas of points 0-1 / 2-3 and
+// 1-2 / 3-4 gives four squared lengths in one register
+__attribute__((target("avx2,fma")))
+double lengthAvx2(const double* xy, std::size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 < n; i += 8) {
+        const double* p = xy + 2 * i;
+        const __m256d a0 = _mm256_sub_pd(_mm256_loadu_pd(p + 2), _mm256_loadu_pd(p));
+        const __m256d b0 = _mm256_sub_pd(_mm256_loadu_pd(p + 6), _mm256_loadu_pd(p + 4));
+        const __m256d a1 = _mm256_sub_pd(_mm256_loadu_pd(p + 10), _mm256_loadu_pd(p + 8));
+        const __m256d b1 = _mm256_sub_pd(_mm256_loadu_pd(p + 14), _mm256_loadu_pd(p + 12));
+        acc0 = _mm256_add_pd(acc0, _mm256_sqrt_pd(_mm256_hadd_pd(_mm256_mul_pd(a0, a0), _mm256_mul_pd(b0, b0))));
+        acc1 = _mm256_add_pd(acc1, _mm256_sqrt_pd(_mm256_hadd_pd(_mm256_mul_pd(a1, a1), _mm256_mul_pd(b1, b1))));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+           (i + 1 < n ? lengthScalar(xy + 2 * i, n - i) : 0.0);
+}
+#endif
+
+struct Kernels {
+    LengthKernel length;
+    const char* name;
+};
+
+Kernels selectKernels() {
+#if GEOMETRY_HAS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {lengthAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {lengthSse2, "sse2"};
+    }
+#endif
+    return {lengthScalar, "scalar"};
+}
+
+// Chosen once, on first use
+const Kernels& kernels() {
+    static const Kernels k = selectKernels();
+    return k;
+}
+
+} // namespace detail
+
+// Total length of the polyline points[0, n)
+double path_length(const Point* points, std::size_t n) {
+    if (n < 2) {
+        return 0.0;
+    }
+    return detail::kernels().length(reinterpret_cast<const double*>(points), n);
+}
+
+double path_length(const std::vector<Point>& track) {
+    return path_length(track.data(), track.size());
+}
+
+struct SimplifyStats {
+    std::size_t input = 0;
+    std::size_t kept = 0;
+    std::chrono::duration<double, std::milli> elapsed{0};
+
+    std::size_t removed() const { return input - kept; }
+
+    SimplifyStats& operator+=(const SimplifyStats& other) {
+        input += other.input;
+        kept += other.kept;
+        elapsed += other.elapsed;
+        return *this;
+    }
+};
+
+namespace detail {
+
+// Squared distance from points to the segment a-b, with the per-segment terms
+// computed once so the inner loop is multiplies and adds only
+struct Segment {
+    double ax, ay, vx, vy, invLen2;
+
+    Segment(const Point& a, const Point& b)
+        : ax(a.x()), ay(a.y()), vx(b.x() - a.x()), vy(b.y() - a.y()) {
+        const double len2 = vx * vx + vy * vy;
+        invLen2 = len2 > 0.0 ? 1.0 / len2 : 0.0;
+    }
+
+    double distance2(const Point& p) const {
+        const double wx = p.x() - ax, wy = p.y() - ay;
+        const double t = std::min(1.0, std::max(0.0, (wx * vx + wy * vy) * invLen2));
+        const double dx = wx - t * vx, dy = wy - t * vy;
+        return dx * dx + dy * dy;
+    }
+};
+
+} // namespace detail
+
+// Douglas-Peucker: appends the kept points of points[0, n) to out (endpoints
+// are always kept). No point of the input is further than tolerance from the
+// simplified line.
+SimplifyStats simplify(const Point* points, std::size_t n, double tolerance,
+                       std::vector<Point>& out) {
+    const auto start = std::chrono::steady_clock::now();
+    SimplifyStats stats;
+    stats.input = n;
+
+    if (n <= 2) {
+        out.insert(out.end(), points, points + n);
+        stats.kept = n;
+        stats.elapsed = std::chrono::steady_clock::now() - start;
+        return stats;
+    }
+
+    const double tolerance2 = tolerance * tolerance;
+    std::vector<std::uint8_t> keep(n, 0);
+    keep[0] = keep[n - 1] = 1;
+
+    std::vector<std::pair<std::size_t, std::size_t>> stack;
+    stack.emplace_back(0, n - 1);
+    while (!stack.empty()) {
+        const std::size_t first = stack.back().first, last = stack.back().second;
+        stack.pop_back();
+
+        const detail::Segment segment(points[first], points[last]);
+        double worst = -1.0;
+        std::size_t worstIndex = first;
+        for (std::size_t i = first + 1; i < last; ++i) {
+            const double d2 = segment.distance2(points[i]);
+            if (d2 > worst) { worst = d2; worstIndex = i; }
+        }
+        if (worst > tolerance2) {
+            keep[worstIndex] = 1;
+            if (worstIndex - first > 1) stack.emplace_back(first, worstIndex);
+            if (last - worstIndex > 1) stack.emplace_back(worstIndex, last);
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (keep[i]) {
+            out.push_back(points[i]);
+            ++stats.kept;
+        }
+    }
+    stats.elapsed = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+std::vector<Point> simplify(const std::vector<Point>& track, double tolerance,
+                            SimplifyStats* stats = nullptr) {
+    std::vector<Point> out;
+    SimplifyStats s = simplify(track.data(), track.size(), tolerance, out);
+    if (stats) *stats = s;
+    return out;
+}
+
+// Simplifies every track independently across threads; the combined stats'
+// elapsed is the wall time of the whole call, not the sum over tracks
+std::vector<std::vector<Point>> simplify_tracks(const std::vector<std::vector<Point>>& tracks,
+                                                double tolerance, SimplifyStats* stats = nullptr,
+                                                unsigned threads = 0) {
+    const auto start = std::chrono::steady_clock::now();
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(1, tracks.size())));
+
+    std::vector<std::vector<Point>> result(tracks.size());
+    std::vector<SimplifyStats> perTrack(tracks.size());
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (std::size_t t; (t = next.fetch_add(1)) < tracks.size();) {
+            perTrack[t] = simplify(tracks[t].data(), tracks[t].size(), tolerance, result[t]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    if (stats) {
+        *stats = SimplifyStats();
+        for (const SimplifyStats& s : perTrack) *stats += s;
+        stats->elapsed = std::chrono::steady_clock::now() - start;
+    }
+    return result;
+}
+
+} // namespace geometry
+
+int main(int argc, char** argv) {
+    const std::size_t tracks = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200;
+    const std::size_t pointsPerTrack = 50000;
+
+    // GPS-like random walks with a slowly turning heading
+    std::mt19937 rng(57);
+    std::normal_distribution<double> turn(0.0, 0.05), noise(0.0, 0.2);
+    std::vector<std::vector<geometry::Point>> data(tracks);
+    for (auto& track : data) {
+        double x = 0, y = 0, heading = 0;
+        track.reserve(pointsPerTrack);
+        for (std::size_t i = 0; i < pointsPerTrack; ++i) {
+            heading += turn(rng);
+            x += std::cos(heading) + noise(rng);
+            y += std::sin(heading) + noise(rng);
+            track.emplace_back(x, y);
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    double naive = 0.0;
+    for (const auto& track : data) {
+        for (std::size_t i = 0; i + 1 < track.size(); ++i) naive += distance(track[i], track[i + 1]);
+    }
+    auto t1 = Clock::now();
+    double fast = 0.0;
+    for (const auto& track : data) fast += path_length(track);  // ADL
+    auto t2 = Clock::now();
+    std::cout << "path_length kernel: " << geometry::detail::kernels().name << "\n";
+    std::cout << "Total length " << fast << " (sequential sum " << naive << ")\n";
+    std::cout << "  sequential sum " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms, path_length " << std::chrono::duration<double, std::milli>(t2 - t1).count()
+              << " ms\n";
+
+    for (double tolerance : {0.5, 2.0, 8.0}) {
+        geometry::SimplifyStats stats;
+        std::vector<std::vector<geometry::Point>> simplified =
+            simplify_tracks(data, tolerance, &stats);
+        double simplifiedLength = 0.0;
+        for (const auto& track : simplified) simplifiedLength += path_length(track);
+        std::cout << "tolerance " << tolerance << ": removed " << stats.removed() << " of "
+                  << stats.input << " points in " << stats.elapsed.count() << " ms, length "
+                  << simplifiedLength << "\n";
+    }
+
+    return 0;
+}
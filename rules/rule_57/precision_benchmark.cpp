@@ -0,0 +1,162 @@
+// Benchmark: memory traffic of BasicPoint<T> at different coordinate precisions
+// geometry::Point (BasicPoint<double>) is 16 bytes per point. Datasets that fit
+// in float32 or int32 grid coordinates only need 8, so a sweep over them moves
+// half the bytes. This sweeps 10M points for each precision and reports the
+// effective bandwidth.
+//
+// The radius test compares squared_distance() with r * r. A distance() <= r
+// loop spends much of its time in sqrt, which hides part of the difference
+// between 16 and 8 bytes per point. The sqrt loop is still timed next to it
+// for comparison.
+//
+// The types below mirror good_example.cpp (trimmed to what the sweep needs).
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace geometry {
+
+class Fixed16 {
+private:
+    std::int32_t raw_;
+
+public:
+    static constexpr int fractionBits = 16;
+
+    constexpr Fixed16() : raw_(0) {}
+    // Out-of-range values saturate, as in good_example.cpp
+    constexpr explicit Fixed16(double value)
+        : raw_(!(value == value) ? 0
+               : value * (1 << fractionBits) >= 2147483647.0 ? INT32_MAX
+               : value * (1 << fractionBits) <= -2147483648.0 ? INT32_MIN
+               : static_cast<std::int32_t>(value * (1 << fractionBits))) {}
+
+    constexpr explicit operator double() const {
+        return static_cast<double>(raw_) / (1 << fractionBits);
+    }
+};
+
+template <typename T>
+class BasicPoint {
+private:
+    T x_, y_;
+
+public:
+    constexpr BasicPoint(T x, T y) : x_(x), y_(y) {}
+
+    constexpr T x() const { return x_; }
+    constexpr T y() const { return y_; }
+};
+
+using Point = BasicPoint<double>;
+
+namespace detail {
+template <typename T>
+using distance_t = std::conditional_t<std::is_same<T, float>::value, float, double>;
+}
+
+template <typename T>
+detail::distance_t<T> distance(const BasicPoint<T>& p1, const BasicPoint<T>& p2) {
+    using D = detail::distance_t<T>;
+    D dx = static_cast<D>(p1.x()) - static_cast<D>(p2.x());
+    D dy = static_cast<D>(p1.y()) - static_cast<D>(p2.y());
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+template <typename T>
+detail::distance_t<T> squared_distance(const BasicPoint<T>& p1, const BasicPoint<T>& p2) {
+    using D = detail::distance_t<T>;
+    D dx = static_cast<D>(p1.x()) - static_cast<D>(p2.x());
+    D dy = static_cast<D>(p1.y()) - static_cast<D>(p2.y());
+    return dx * dx + dy * dy;
+}
+
+} // namespace geometry
+
+namespace {
+
+// Best time of several passes of count(), which returns the number of hits
+template <typename Count>
+double bestOf(int passes, Count count, std::size_t& hits) {
+    using Clock = std::chrono::steady_clock;
+    double bestMs = 1e300;
+    for (int pass = 0; pass < passes; ++pass) {
+        auto start = Clock::now();
+        hits = count();
+        bestMs = std::min(bestMs,
+                          std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return bestMs;
+}
+
+// Counts points within radius of query, by squared distance and by distance
+template <typename T>
+void sweep(const char* name, const std::vector<geometry::BasicPoint<T>>& points,
+           const geometry::BasicPoint<T>& query, double radius, int passes) {
+    using D = geometry::detail::distance_t<T>;
+    const D r = static_cast<D>(radius);
+    const D r2 = r * r;
+
+    std::size_t hits = 0, sqrtHits = 0;
+    const double ms = bestOf(passes, [&] {
+        std::size_t count = 0;
+        for (const auto& p : points) count += squared_distance(p, query) <= r2;  // ADL
+        return count;
+    }, hits);
+    const double sqrtMs = bestOf(passes, [&] {
+        std::size_t count = 0;
+        for (const auto& p : points) count += distance(p, query) <= r;  // ADL
+        return count;
+    }, sqrtHits);
+
+    const double bytes = static_cast<double>(points.size() * sizeof(geometry::BasicPoint<T>));
+    std::cout << "  " << name << ": " << sizeof(geometry::BasicPoint<T>) << " B/point, "
+              << ms << " ms, " << bytes / (ms * 1e6) << " GB/s, "
+              << hits << " hits (with sqrt: " << sqrtMs << " ms"
+              << (sqrtHits == hits ? "" : ", HIT COUNT DIFFERS") << ")\n";
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    const int passes = 5;
+
+    // Integer grid coordinates, representable exactly in every precision
+    std::mt19937 rng(57);
+    std::uniform_int_distribution<std::int32_t> coord(0, 4095);
+
+    std::vector<geometry::Point> asDouble;
+    std::vector<geometry::BasicPoint<float>> asFloat;
+    std::vector<geometry::BasicPoint<std::int32_t>> asInt;
+    std::vector<geometry::BasicPoint<geometry::Fixed16>> asFixed;
+    asDouble.reserve(n);
+    asFloat.reserve(n);
+    asInt.reserve(n);
+    asFixed.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::int32_t x = coord(rng), y = coord(rng);
+        asDouble.emplace_back(x, y);
+        asFloat.emplace_back(static_cast<float>(x), static_cast<float>(y));
+        asInt.emplace_back(x, y);
+        asFixed.emplace_back(geometry::Fixed16(x), geometry::Fixed16(y));
+    }
+
+    std::cout << "Sweep over " << n << " points (best of " << passes << " passes):\n";
+    sweep("double ", asDouble, geometry::Point(2048, 2048), 1000.0, passes);
+    sweep("float  ", asFloat, geometry::BasicPoint<float>(2048.0f, 2048.0f), 1000.0, passes);
+    sweep("int32  ", asInt, geometry::BasicPoint<std::int32_t>(2048, 2048), 1000.0, passes);
+    sweep("Q16.16 ", asFixed,
+          geometry::BasicPoint<geometry::Fixed16>(geometry::Fixed16(2048.0), geometry::Fixed16(2048.0)),
+          1000.0, passes);
+
+    return 0;
+}
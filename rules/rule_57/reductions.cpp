@@ -0,0 +1,385 @@
+// Good: Bulk reductions over point sets as part of Point's interface in namespace geometry
+// midpoint builds one Point at a time; aggregation code needs centroids,
+// bounding boxes and per-segment midpoints over huge spans.
+//
+// Determinism: inputs are cut into fixed-size chunks whose boundaries depend only
+// on the input size, never on the thread count. Each chunk is reduced with a
+// fixed lane layout (shared by the scalar and SIMD kernels) and the per-chunk
+// partials are combined in chunk order, so the result is bit-identical whether
+// one thread or thirty-two did the work, on any of the kernels.
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_HAS_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define GEOMETRY_HAS_X86_SIMD 0
+#endif
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+Point midpoint(const Point& p1, const Point& p2) {
+    return Point((p1.x() + p2.x()) / 2.0,
+                 (p1.y() + p2.y()) / 2.0);
+}
+
+std::ostream& operator<<(std::ostream& os, const Point& p) {
+    return os << "(" << p.x() << ", " << p.y() << ")";
+}
+
+// Axis-aligned bounding box; an empty box has min > max
+struct Box {
+    Point min, max;
+
+    bool empty() const { return min.x() > max.x() || min.y() > max.y(); }
+};
+
+std::ostream& operator<<(std::ostream& os, const Box& b) {
+    return os << "[" << b.min << " - " << b.max << "]";
+}
+
+// How much parallelism a bulk call may use. Inputs below parallelThreshold
+// always run on the calling thread.
+struct ExecutionPolicy {
+    unsigned threads = 0;                        // 0 = hardware_concurrency()
+    std::size_t parallelThreshold = 1 << 16;
+
+    static ExecutionPolicy sequential() { return {1, 0}; }
+    static ExecutionPolicy parallel(unsigned threads = 0) { return {threads, 0}; }
+};
+
+namespace detail {
+
+// Fixed so that chunk boundaries (and therefore rounding) never depend on threads
+constexpr std::size_t chunkSize = 1 << 14;
+
+std::size_t chunkCount(std::size_t n) { return (n + chunkSize - 1) / chunkSize; }
+
+// Runs body(chunk) for every chunk, on as many threads as the policy allows
+template <typename Body>
+void forEachChunk(std::size_t n, const ExecutionPolicy& policy, Body body) {
+    const std::size_t chunks = chunkCount(n);
+    unsigned threads = policy.threads ? policy.threads
+                                      : std::max(1u, std::thread::hardware_concurrency());
+    if (n < policy.parallelThreshold) {
+        threads = 1;
+    }
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, chunks));
+
+    if (threads <= 1) {
+        for (std::size_t c = 0; c < chunks; ++c) body(c);
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (std::size_t c; (c = next.fetch_add(1)) < chunks;) body(c);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+struct Sum { double x, y; };
+struct Extent { double minX, minY, maxX, maxY; };
+
+// The chunk kernels read a Point array as interleaved x, y doubles
+static_assert(sizeof(Point) == 2 * sizeof(double) && std::is_standard_layout<Point>::value,
+              "Point must be two packed doubles");
+
+// Every kernel keeps eight independent accumulator lanes over the interleaved
+// doubles (even lanes x, odd lanes y, four points per step), so no loop is
+// one serial add / min / max chain. The SIMD kernels hold the same eight lanes
+// in registers, the tail goes to lanes 0 and 1 and lanes are combined in a
+// fixed order, so every kernel returns bit-identical results.
+constexpr std::size_t lanes = 8;
+
+using SumKernel = Sum (*)(const double* xy, std::size_t count);
+using ExtentKernel = Extent (*)(const double* xy, std::size_t count);
+
+Sum sumLanes(const double* acc, const double* xy, std::size_t body, std::size_t count) {
+    double x = 0.0, y = 0.0;
+    for (std::size_t i = body; i < count; ++i) {
+        x += xy[2 * i];
+        y += xy[2 * i + 1];
+    }
+    return {((acc[0] + x) + acc[2]) + (acc[4] + acc[6]), ((acc[1] + y) + acc[3]) + (acc[5] + acc[7])};
+}
+
+Extent extentLanes(double* lo, double* hi, const double* xy, std::size_t body, std::size_t count) {
+    for (std::size_t i = body; i < count; ++i) {
+        lo[0] = std::min(lo[0], xy[2 * i]); hi[0] = std::max(hi[0], xy[2 * i]);
+        lo[1] = std::min(lo[1], xy[2 * i + 1]); hi[1] = std::max(hi[1], xy[2 * i + 1]);
+    }
+    return {std::min(std::min(lo[0], lo[2]), std::min(lo[4], lo[6])),
+            std::min(std::min(lo[1], lo[3]), std::min(lo[5], lo[7])),
+            std::max(std::max(hi[0], hi[2]), std::max(hi[4], hi[6])),
+            std::max(std::max(hi[1], hi[3]), std::max(hi[5], hi[7]))};
+}
+
+Sum sumScalar(const double* xy, std::size_t count) {
+    double acc[lanes] = {};
+    const std::size_t body = count - count % (lanes / 2);
+    for (std::size_t i = 0; i < 2 * body; i += lanes) {
+        for (std::size_t l = 0; l < lanes; ++l) acc[l] += xy[i + l];
+    }
+    return sumLanes(acc, xy, body, count);
+}
+
+Extent extentScalar(const double* xy, std::size_t count) {
+    double lo[lanes], hi[lanes];
+    std::fill(lo, lo + lanes, std::numeric_limits<double>::infinity());
+    std::fill(hi, hi + lanes, -std::numeric_limits<double>::infinity());
+    const std::size_t body = count - count % (lanes / 2);
+    for (std::size_t i = 0; i < 2 * body; i += lanes) {
+        for (std::size_t l = 0; l < lanes; ++l) {
+            lo[l] = std::min(lo[l], xy[i + l]);
+            hi[l] = std::max(hi[l], xy[i + l]);
+        }
+    }
+    return extentLanes(lo, hi, xy, body, count);
+}
+
+#if GEOMETRY_HAS_X86_SIMD
+// min_pd(v, lo) is v < lo ? v : lo, exactly std::min(lo, v)
+__attribute__((target("sse2")))
+Extent extentSse2(const double* xy, std::size_t count) {
+    const __m128d inf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    __m128d lo[4] = {inf, inf, inf, inf};
+    __m128d hi[4] = {_mm_sub_pd(_mm_setzero_pd(), inf), _mm_sub_pd(_mm_setzero_pd(), inf),
+                     _mm_sub_pd(_mm_setzero_pd(), inf), _mm_sub_pd(_mm_setzero_pd(), inf)};
+    const std::size_t body = count - count % (lanes / 2);
+    for (std::size_t i = 0; i < 2 * body; i += lanes) {
+        for (int r = 0; r < 4; ++r) {
+            const __m128d v = _mm_loadu_pd(xy + i + 2 * r);
+            lo[r] = _mm_min_pd(v, lo[r]);
+            hi[r] = _mm_max_pd(v, hi[r]);
+        }
+    }
+    alignas(16) double l[lanes], h[lanes];
+    for (int r = 0; r < 4; ++r) {
+        _mm_store_pd(l + 2 * r, lo[r]);
+        _mm_store_pd(h + 2 * r, hi[r]);
+    }
+    return extentLanes(l, h, xy, body, count);
+}
+
+__attribute__((target("avx2")))
+Sum sumAvx2(const double* xy, std::size_t count) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    const std::size_t body = count - count % (lanes / 2);
+    for (std::size_t i = 0; i < 2 * body; i += lanes) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(xy + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(xy + i + 4));
+    }
+    alignas(32) double acc[lanes];
+    _mm256_store_pd(acc, acc0);
+    _mm256_store_pd(acc + 4, acc1);
+    return sumLanes(acc, xy, body, count);
+}
+
+__attribute__((target("avx2")))
+Extent extentAvx2(const double* xy, std::size_t count) {
+    const __m256d inf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    const __m256d ninf = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    __m256d lo0 = inf, lo1 = inf, hi0 = ninf, hi1 = ninf;
+    const std::size_t body = count - count % (lanes / 2);
+    for (std::size_t i = 0; i < 2 * body; i += lanes) {
+        const __m256d v0 = _mm256_loadu_pd(xy + i), v1 = _mm256_loadu_pd(xy + i + 4);
+        lo0 = _mm256_min_pd(v0, lo0); hi0 = _mm256_max_pd(v0, hi0);
+        lo1 = _mm256_min_pd(v1, lo1); hi1 = _mm256_max_pd(v1, hi1);
+    }
+    alignas(32) double l[lanes], h[lanes];
+    _mm256_store_pd(l, lo0); _mm256_store_pd(l + 4, lo1);
+    _mm256_store_pd(h, hi0); _mm256_store_pd(h + 4, hi1);
+    return extentLanes(l, h, xy, body, count);
+}
+#endif
+
+struct Kernels {
+    SumKernel sum;
+    ExtentKernel extent;
+    const char* name;
+};
+
+// The scalar sum loop already vectorizes with SSE2; the extent loop does not,
+// since std::min / std::max only map to minpd / maxpd under -ffast-math
+Kernels selectKernels() {
+#if GEOMETRY_HAS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {sumAvx2, extentAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {sumScalar, extentSse2, "sse2"};
+    }
+#endif
+    return {sumScalar, extentScalar, "scalar"};
+}
+
+// Chosen once, on first use
+const Kernels& kernels() {
+    static const Kernels k = selectKernels();
+    return k;
+}
+
+Sum sumChunk(const Point* p, std::size_t count) {
+    return kernels().sum(reinterpret_cast<const double*>(p), count);
+}
+
+Extent extentChunk(const Point* p, std::size_t count) {
+    return kernels().extent(reinterpret_cast<const double*>(p), count);
+}
+
+} // namespace detail
+
+// ============================================================================
+// Bulk interface
+// ============================================================================
+
+// Mean of points[0, n); throws for an empty input
+Point centroid(const Point* points, std::size_t n,
+               const ExecutionPolicy& policy = ExecutionPolicy()) {
+    if (n == 0) {
+        throw std::invalid_argument("centroid: empty point set");
+    }
+    std::vector<detail::Sum> partial(detail::chunkCount(n));
+    detail::forEachChunk(n, policy, [&](std::size_t c) {
+        const std::size_t begin = c * detail::chunkSize;
+        partial[c] = detail::sumChunk(points + begin, std::min(detail::chunkSize, n - begin));
+    });
+
+    double sx = 0.0, sy = 0.0;
+    for (const auto& s : partial) {   // fixed combination order
+        sx += s.x;
+        sy += s.y;
+    }
+    return Point(sx / static_cast<double>(n), sy / static_cast<double>(n));
+}
+
+// Bounding box of points[0, n); empty() for an empty input
+Box bounds(const Point* points, std::size_t n,
+           const ExecutionPolicy& policy = ExecutionPolicy()) {
+    std::vector<detail::Extent> partial(detail::chunkCount(n));
+    detail::forEachChunk(n, policy, [&](std::size_t c) {
+        const std::size_t begin = c * detail::chunkSize;
+        partial[c] = detail::extentChunk(points + begin, std::min(detail::chunkSize, n - begin));
+    });
+
+    detail::Extent e{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                     -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    for (const auto& p : partial) {
+        e.minX = std::min(e.minX, p.minX);
+        e.minY = std::min(e.minY, p.minY);
+        e.maxX = std::max(e.maxX, p.maxX);
+        e.maxY = std::max(e.maxY, p.maxY);
+    }
+    return Box{Point(e.minX, e.minY), Point(e.maxX, e.maxY)};
+}
+
+// out[i] = midpoint(a[i], b[i]) for i in [0, n); out may alias a or b
+void midpoints(const Point* a, const Point* b, std::size_t n, Point* out,
+               const ExecutionPolicy& policy = ExecutionPolicy()) {
+    detail::forEachChunk(n, policy, [&](std::size_t c) {
+        const std::size_t begin = c * detail::chunkSize;
+        const std::size_t end = std::min(begin + detail::chunkSize, n);
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = midpoint(a[i], b[i]);
+        }
+    });
+}
+
+// Convenience overloads for the common container
+Point centroid(const std::vector<Point>& points, const ExecutionPolicy& policy = ExecutionPolicy()) {
+    return centroid(points.data(), points.size(), policy);
+}
+
+Box bounds(const std::vector<Point>& points, const ExecutionPolicy& policy = ExecutionPolicy()) {
+    return bounds(points.data(), points.size(), policy);
+}
+
+} // namespace geometry
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 5000000;
+
+    std::mt19937 rng(57);
+    std::normal_distribution<double> coord(100.0, 25.0);
+    std::vector<geometry::Point> a, b;
+    a.reserve(n);
+    b.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        a.emplace_back(coord(rng), coord(rng));
+        b.emplace_back(coord(rng), coord(rng));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    geometry::Point cSeq = centroid(a, geometry::ExecutionPolicy::sequential());  // ADL
+    auto t1 = Clock::now();
+    geometry::Point cPar = centroid(a, geometry::ExecutionPolicy::parallel());
+    auto t2 = Clock::now();
+    geometry::Point cFour = centroid(a, geometry::ExecutionPolicy::parallel(4));
+
+    std::cout << "Centroid (1 thread):  " << cSeq << " in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+    std::cout << "Centroid (parallel):  " << cPar << " in "
+              << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms\n";
+    std::cout << "Bit-identical across thread counts: "
+              << ((cSeq.x() == cPar.x() && cSeq.y() == cPar.y() &&
+                   cSeq.x() == cFour.x() && cSeq.y() == cFour.y()) ? "yes" : "no") << "\n";
+
+    // Every kernel keeps the same lanes, so the dispatched one matches the scalar one bit for bit
+    const auto* xy = reinterpret_cast<const double*>(a.data());
+    const geometry::detail::Sum sumRef = geometry::detail::sumScalar(xy, n);
+    const geometry::detail::Sum sumSel = geometry::detail::kernels().sum(xy, n);
+    const geometry::detail::Extent extRef = geometry::detail::extentScalar(xy, n);
+    const geometry::detail::Extent extSel = geometry::detail::kernels().extent(xy, n);
+    std::cout << "Chunk kernels (" << geometry::detail::kernels().name << ") match scalar lanes: "
+              << ((sumRef.x == sumSel.x && sumRef.y == sumSel.y && extRef.minX == extSel.minX &&
+                   extRef.minY == extSel.minY && extRef.maxX == extSel.maxX && extRef.maxY == extSel.maxY)
+                  ? "yes" : "no") << "\n";
+
+    auto t3 = Clock::now();
+    const geometry::Box box = bounds(a, geometry::ExecutionPolicy::sequential());
+    auto t4 = Clock::now();
+    std::cout << "Bounds: " << box << " in " << std::chrono::duration<double, std::milli>(t4 - t3).count()
+              << " ms (1 thread)\n";
+
+    std::vector<geometry::Point> mids(n, geometry::Point(0, 0));
+    midpoints(a.data(), b.data(), n, mids.data());
+    std::cout << "midpoints[0] = " << mids[0] << " (scalar: " << midpoint(a[0], b[0]) << ")\n";
+
+    // Small inputs stay on the calling thread under the default policy
+    geometry::Point tiny[] = {geometry::Point(0, 0), geometry::Point(2, 4)};
+    std::cout << "Centroid of 2 points: " << centroid(tiny, 2) << "\n";
+
+    return 0;
+}
@@ -0,0 +1,310 @@
+// Good: Online statistics over unbounded point streams, in namespace geometry with Point
+// RunningStats keeps centroid, variance/covariance and bounding box of every
+// point pushed so far in constant space, so a live feed never has to be buffered.
+//
+//   push(p):        Welford update, numerically stable for long streams whose
+//                   values sit far from the origin
+//   push(points, n): the batch is reduced block by block (two passes over an
+//                   L1-sized block with independent accumulators, which the
+//                   compiler vectorizes) and each block is merged in
+//   merge(other):   Chan et al. pairwise combination, so per-thread
+//                   accumulators can be reduced into one
+//   snapshot():     safe from any thread while the owning thread keeps pushing.
+//                   Each push/merge publishes its result through a sequence
+//                   lock: the writer never waits, readers retry only if a
+//                   publish overlapped their read.
+//
+// One thread owns a RunningStats and calls push/merge; any number of threads
+// may call snapshot(). Variances are population variances (divided by n).
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+std::ostream& operator<<(std::ostream& os, const Point& p) {
+    return os << "(" << p.x() << ", " << p.y() << ")";
+}
+
+// Axis-aligned bounding box; an empty box has min > max
+struct Box {
+    Point min, max;
+
+    bool empty() const { return min.x() > max.x() || min.y() > max.y(); }
+};
+
+std::ostream& operator<<(std::ostream& os, const Box& b) {
+    return os << "[" << b.min << " - " << b.max << "]";
+}
+
+// A consistent view of a RunningStats at one moment
+struct StatsSnapshot {
+    std::uint64_t count = 0;
+    Point centroid{0.0, 0.0};
+    double varianceX = 0.0, varianceY = 0.0, covarianceXY = 0.0;
+    Box bounds{Point(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()),
+               Point(-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity())};
+};
+
+class RunningStats {
+private:
+    // Count, means, sums of squared/cross deviations from the mean, and bounds
+    struct State {
+        std::uint64_t count = 0;
+        double meanX = 0.0, meanY = 0.0;
+        double m2X = 0.0, m2Y = 0.0, cXY = 0.0;
+        double minX = std::numeric_limits<double>::infinity(), minY = minX;
+        double maxX = -std::numeric_limits<double>::infinity(), maxY = maxX;
+    };
+
+    static constexpr std::size_t blockSize = 1024;
+    static constexpr std::size_t fields = 10;
+
+    State state_;
+    std::atomic<std::uint64_t> sequence_{0};
+    std::atomic<double> published_[fields];
+
+    static void combine(State& into, const State& other) {
+        if (other.count == 0) return;
+        if (into.count == 0) { into = other; return; }
+        const double na = static_cast<double>(into.count), nb = static_cast<double>(other.count);
+        const double n = na + nb;
+        const double dx = other.meanX - into.meanX, dy = other.meanY - into.meanY;
+        const double w = na * nb / n;
+        into.meanX += dx * nb / n;
+        into.meanY += dy * nb / n;
+        into.m2X += other.m2X + dx * dx * w;
+        into.m2Y += other.m2Y + dy * dy * w;
+        into.cXY += other.cXY + dx * dy * w;
+        into.count += other.count;
+        into.minX = std::min(into.minX, other.minX); into.minY = std::min(into.minY, other.minY);
+        into.maxX = std::max(into.maxX, other.maxX); into.maxY = std::max(into.maxY, other.maxY);
+    }
+
+    // Exact two-pass statistics of one block, four lanes per accumulator;
+    // n must be a multiple of 4
+    static State reduceBlock(const Point* points, std::size_t n) {
+        double sx[4] = {0, 0, 0, 0}, sy[4] = {0, 0, 0, 0};
+        double lox[4], loy[4], hix[4], hiy[4];
+        std::fill(lox, lox + 4, std::numeric_limits<double>::infinity());
+        std::fill(loy, loy + 4, std::numeric_limits<double>::infinity());
+        std::fill(hix, hix + 4, -std::numeric_limits<double>::infinity());
+        std::fill(hiy, hiy + 4, -std::numeric_limits<double>::infinity());
+        for (std::size_t i = 0; i < n; i += 4) {
+            for (std::size_t lane = 0; lane < 4; ++lane) {
+                const double x = points[i + lane].x(), y = points[i + lane].y();
+                sx[lane] += x; sy[lane] += y;
+                lox[lane] = std::min(lox[lane], x); loy[lane] = std::min(loy[lane], y);
+                hix[lane] = std::max(hix[lane], x); hiy[lane] = std::max(hiy[lane], y);
+            }
+        }
+        State s;
+        s.count = n;
+        s.meanX = ((sx[0] + sx[1]) + (sx[2] + sx[3])) / static_cast<double>(n);
+        s.meanY = ((sy[0] + sy[1]) + (sy[2] + sy[3])) / static_cast<double>(n);
+        s.minX = std::min(std::min(lox[0], lox[1]), std::min(lox[2], lox[3]));
+        s.minY = std::min(std::min(loy[0], loy[1]), std::min(loy[2], loy[3]));
+        s.maxX = std::max(std::max(hix[0], hix[1]), std::max(hix[2], hix[3]));
+        s.maxY = std::max(std::max(hiy[0], hiy[1]), std::max(hiy[2], hiy[3]));
+
+        double qx[4] = {0, 0, 0, 0}, qy[4] = {0, 0, 0, 0}, qxy[4] = {0, 0, 0, 0};
+        for (std::size_t i = 0; i < n; i += 4) {
+            for (std::size_t lane = 0; lane < 4; ++lane) {
+                const double dx = points[i + lane].x() - s.meanX, dy = points[i + lane].y() - s.meanY;
+                qx[lane] += dx * dx; qy[lane] += dy * dy; qxy[lane] += dx * dy;
+            }
+        }
+        s.m2X = (qx[0] + qx[1]) + (qx[2] + qx[3]);
+        s.m2Y = (qy[0] + qy[1]) + (qy[2] + qy[3]);
+        s.cXY = (qxy[0] + qxy[1]) + (qxy[2] + qxy[3]);
+        return s;
+    }
+
+    // Welford update
+    void pushOne(const Point& p) {
+        State& s = state_;
+        ++s.count;
+        const double dx = p.x() - s.meanX, dy = p.y() - s.meanY;
+        s.meanX += dx / static_cast<double>(s.count);
+        s.meanY += dy / static_cast<double>(s.count);
+        s.m2X += dx * (p.x() - s.meanX);
+        s.m2Y += dy * (p.y() - s.meanY);
+        s.cXY += dx * (p.y() - s.meanY);
+        s.minX = std::min(s.minX, p.x()); s.minY = std::min(s.minY, p.y());
+        s.maxX = std::max(s.maxX, p.x()); s.maxY = std::max(s.maxY, p.y());
+    }
+
+    void publish() {
+        const double values[fields] = {static_cast<double>(state_.count), state_.meanX, state_.meanY,
+                                       state_.m2X, state_.m2Y, state_.cXY,
+                                       state_.minX, state_.minY, state_.maxX, state_.maxY};
+        const std::uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);       // odd: publish in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t f = 0; f < fields; ++f) published_[f].store(values[f], std::memory_order_relaxed);
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+public:
+    RunningStats() {
+        for (auto& f : published_) f.store(0.0, std::memory_order_relaxed);
+        publish();
+    }
+
+    // Copies the owner-side state; the copy has its own publication
+    RunningStats(const RunningStats& other) : state_(other.state_) {
+        publish();
+    }
+
+    RunningStats& operator=(const RunningStats& other) {
+        state_ = other.state_;
+        publish();
+        return *this;
+    }
+
+    void push(const Point& p) {
+        pushOne(p);
+        publish();
+    }
+
+    void push(const Point* points, std::size_t n) {
+        const std::size_t body = n & ~std::size_t(3);
+        for (std::size_t i = 0; i < body; i += blockSize) {
+            combine(state_, reduceBlock(points + i, std::min(blockSize, body - i)));
+        }
+        for (std::size_t i = body; i < n; ++i) pushOne(points[i]);
+        publish();
+    }
+
+    void push(const std::vector<Point>& points) {
+        push(points.data(), points.size());
+    }
+
+    // Folds other's points into this one; other must not be written concurrently
+    void merge(const RunningStats& other) {
+        combine(state_, other.state_);
+        publish();
+    }
+
+    std::uint64_t count() const { return state_.count; }
+
+    // Callable from any thread
+    StatsSnapshot snapshot() const {
+        double values[fields];
+        std::uint64_t before, after;
+        do {
+            before = sequence_.load(std::memory_order_acquire);
+            for (std::size_t f = 0; f < fields; ++f) values[f] = published_[f].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence_.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        StatsSnapshot snap;
+        snap.count = static_cast<std::uint64_t>(values[0]);
+        if (snap.count == 0) return snap;
+        const double n = values[0];
+        snap.centroid = Point(values[1], values[2]);
+        snap.varianceX = values[3] / n;
+        snap.varianceY = values[4] / n;
+        snap.covarianceXY = values[5] / n;
+        snap.bounds = Box{Point(values[6], values[7]), Point(values[8], values[9])};
+        return snap;
+    }
+};
+
+} // namespace geometry
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000000;
+
+    // A correlated cloud far from the origin, where naive sum-of-squares fails
+    std::mt19937 rng(57);
+    std::normal_distribution<double> gauss(0.0, 1.0);
+    std::vector<geometry::Point> feed;
+    feed.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double u = gauss(rng), v = gauss(rng);
+        feed.emplace_back(1e6 + 3.0 * u, -2e6 + 2.0 * u + v);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    // One point at a time, with a monitor thread sampling snapshots meanwhile
+    geometry::RunningStats single;
+    std::atomic<bool> done{false};
+    std::size_t samples = 0, inconsistent = 0;
+    std::thread monitor([&] {
+        std::uint64_t lastCount = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            geometry::StatsSnapshot snap = single.snapshot();
+            ++samples;
+            if (snap.count < lastCount || (snap.count > 0 && snap.bounds.empty())) ++inconsistent;
+            lastCount = snap.count;
+        }
+    });
+    auto t0 = Clock::now();
+    for (const geometry::Point& p : feed) single.push(p);
+    auto t1 = Clock::now();
+    done.store(true, std::memory_order_release);
+    monitor.join();
+
+    // Batched, as a feed arriving in 4096-point packets
+    geometry::RunningStats batched;
+    auto t2 = Clock::now();
+    for (std::size_t i = 0; i < n; i += 4096) batched.push(feed.data() + i, std::min<std::size_t>(4096, n - i));
+    auto t3 = Clock::now();
+
+    // Per-thread accumulators merged at the end
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<geometry::RunningStats> partial(threads);
+    auto t4 = Clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            const std::size_t begin = n * t / threads, end = n * (t + 1) / threads;
+            partial[t].push(feed.data() + begin, end - begin);
+        });
+    }
+    for (auto& th : pool) th.join();
+    geometry::RunningStats merged;
+    for (const auto& p : partial) merged.merge(p);
+    auto t5 = Clock::now();
+
+    auto show = [](const char* label, const geometry::StatsSnapshot& s) {
+        std::cout << label << s.count << " points, centroid " << s.centroid << ", var ("
+                  << s.varianceX << ", " << s.varianceY << "), cov " << s.covarianceXY << "\n";
+    };
+    std::cout << "Expected: var (9, 5), cov 6\n";
+    show("  push(p):         ", single.snapshot());
+    show("  push(batch):     ", batched.snapshot());
+    show("  merged threads:  ", merged.snapshot());
+    std::cout << "  bounds " << merged.snapshot().bounds << "\n";
+    std::cout << "push(p) " << ms(t1 - t0) << " ms, push(batch) " << ms(t3 - t2) << " ms, "
+              << threads << " threads + merge " << ms(t5 - t4) << " ms\n";
+    std::cout << "Monitor took " << samples << " snapshots during push(p), " << inconsistent
+              << " inconsistent\n";
+
+    return 0;
+}
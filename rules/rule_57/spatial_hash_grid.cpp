@@ -0,0 +1,355 @@
+// Good: A dynamic spatial index for Point, with its query functions in namespace geometry
+// A k-d tree has to be rebuilt whenever points move. SpatialHashGrid hashes
+// points into square cells of a configurable size instead, so moving a point is
+// O(1) and radius queries only look at the few cells the circle overlaps.
+//
+// Storage: cells are hashed into a power-of-two bucket table laid out as one
+// flat array (CSR: bucketStart[b] .. bucketStart[b + 1] index into items_),
+// built by a counting sort. Points that change cell between rebuilds are kept
+// on a small pending list and marked so the stale CSR entry is skipped; once the
+// list grows past a fraction of the population the grid re-sorts itself.
+//
+// Radius queries clamp their cell range to the cells occupied at the last
+// rebuild, and scan the indexed points directly when that range still has
+// more cells than there are points, so a huge radius costs O(n), not O(r^2).
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace geometry {
+
+class Point {
+private:
+    double x_, y_;
+
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    double x() const { return x_; }
+    double y() const { return y_; }
+};
+
+double distance(const Point& p1, const Point& p2) {
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+class SpatialHashGrid {
+public:
+    using Id = std::uint32_t;
+
+private:
+    struct Cell {
+        std::int32_t cx, cy;
+        bool operator==(const Cell& o) const { return cx == o.cx && cy == o.cy; }
+    };
+
+    double cellSize_, inverseCellSize_;
+
+    // Per-id state, indexed by Id
+    std::vector<double> xs_, ys_;
+    std::vector<Cell> cells_;
+    std::vector<std::uint8_t> alive_, pending_;
+    std::vector<Id> freeIds_;
+    std::size_t liveCount_ = 0;
+
+    // CSR bucket table, valid as of the last rebuild()
+    std::vector<std::uint32_t> bucketStart_;
+    std::vector<Id> items_;
+    std::size_t bucketMask_ = 0;
+    Cell minCell_{0, 0}, maxCell_{-1, -1};   // bounds of the cells in items_
+
+    // Ids that changed cell (or were inserted) since the last rebuild()
+    std::vector<Id> pendingList_;
+
+    // Clamped before the cast: converting an out-of-range double is undefined
+    static std::int32_t cellCoord(double scaled) {
+        const double f = std::floor(scaled);
+        if (std::isnan(f)) return 0;
+        return static_cast<std::int32_t>(std::min(std::max(f, double(INT32_MIN)), double(INT32_MAX)));
+    }
+
+    Cell cellOf(double x, double y) const {
+        return Cell{cellCoord(x * inverseCellSize_), cellCoord(y * inverseCellSize_)};
+    }
+
+    std::size_t bucketOf(const Cell& c) const {
+        std::uint64_t h = static_cast<std::uint32_t>(c.cx) * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<std::uint32_t>(c.cy) * 0xC2B2AE3D27D4EB4Full;
+        return static_cast<std::size_t>(h ^ (h >> 32)) & bucketMask_;
+    }
+
+    void markPending(Id id) {
+        if (!pending_[id]) {
+            pending_[id] = 1;
+            pendingList_.push_back(id);
+        }
+        if (pendingList_.size() > std::max<std::size_t>(1024, liveCount_ / 8)) {
+            rebuild();
+        }
+    }
+
+    // Calls fn(id) for every live id whose current cell is c
+    template <typename Fn>
+    void visitCell(const Cell& c, Fn&& fn) const {
+        if (!items_.empty()) {
+            const std::size_t b = bucketOf(c);
+            for (std::uint32_t k = bucketStart_[b]; k < bucketStart_[b + 1]; ++k) {
+                const Id id = items_[k];
+                if (alive_[id] && !pending_[id] && cells_[id] == c) fn(id);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void visitWithin(double x, double y, double radius, Fn&& fn) const {
+        const double r2 = radius * radius;
+        auto test = [&](Id id) {
+            const double dx = xs_[id] - x, dy = ys_[id] - y;
+            if (dx * dx + dy * dy <= r2) fn(id);
+        };
+        const Cell lo = cellOf(x - radius, y - radius), hi = cellOf(x + radius, y + radius);
+        const std::int64_t x0 = std::max(lo.cx, minCell_.cx), x1 = std::min(hi.cx, maxCell_.cx);
+        const std::int64_t y0 = std::max(lo.cy, minCell_.cy), y1 = std::min(hi.cy, maxCell_.cy);
+        if (x0 <= x1 && y0 <= y1) {
+            const double cellsInRange = static_cast<double>(x1 - x0 + 1) * static_cast<double>(y1 - y0 + 1);
+            if (cellsInRange > static_cast<double>(items_.size())) {
+                for (Id id : items_) {
+                    if (alive_[id] && !pending_[id]) test(id);
+                }
+            } else {
+                for (std::int64_t cy = y0; cy <= y1; ++cy) {
+                    for (std::int64_t cx = x0; cx <= x1; ++cx) {
+                        visitCell(Cell{static_cast<std::int32_t>(cx), static_cast<std::int32_t>(cy)}, test);
+                    }
+                }
+            }
+        }
+        for (Id id : pendingList_) {
+            if (alive_[id]) test(id);
+        }
+    }
+
+public:
+    explicit SpatialHashGrid(double cellSize)
+        : cellSize_(cellSize), inverseCellSize_(1.0 / cellSize) {
+        if (!(cellSize > 0)) {
+            throw std::invalid_argument("SpatialHashGrid: cell size must be positive");
+        }
+    }
+
+    double cellSize() const { return cellSize_; }
+    std::size_t size() const { return liveCount_; }
+
+    Id insert(const Point& p) {
+        Id id;
+        if (!freeIds_.empty()) {
+            id = freeIds_.back();
+            freeIds_.pop_back();
+        } else {
+            id = static_cast<Id>(xs_.size());
+            xs_.push_back(0); ys_.push_back(0);
+            cells_.push_back(Cell{0, 0});
+            alive_.push_back(0); pending_.push_back(0);
+        }
+        xs_[id] = p.x();
+        ys_[id] = p.y();
+        cells_[id] = cellOf(p.x(), p.y());
+        alive_[id] = 1;
+        ++liveCount_;
+        markPending(id);
+        return id;
+    }
+
+    // O(1): only a change of cell touches anything beyond the coordinates
+    void move(Id id, const Point& p) {
+        xs_[id] = p.x();
+        ys_[id] = p.y();
+        const Cell c = cellOf(p.x(), p.y());
+        if (!(c == cells_[id])) {
+            cells_[id] = c;
+            markPending(id);
+        }
+    }
+
+    void remove(Id id) {
+        if (!alive_[id]) return;
+        alive_[id] = 0;
+        --liveCount_;
+        freeIds_.push_back(id);
+    }
+
+    Point position(Id id) const { return Point(xs_[id], ys_[id]); }
+
+    // Counting sort of all live ids into the CSR bucket table
+    void rebuild() {
+        std::size_t buckets = 16;
+        while (buckets < 2 * liveCount_) buckets <<= 1;
+        bucketMask_ = buckets - 1;
+
+        bucketStart_.assign(buckets + 1, 0);
+        for (Id id = 0; id < xs_.size(); ++id) {
+            if (alive_[id]) ++bucketStart_[bucketOf(cells_[id]) + 1];
+        }
+        for (std::size_t b = 0; b < buckets; ++b) {
+            bucketStart_[b + 1] += bucketStart_[b];
+        }
+        items_.resize(liveCount_);
+        std::vector<std::uint32_t> cursor(bucketStart_.begin(), bucketStart_.end() - 1);
+        minCell_ = Cell{INT32_MAX, INT32_MAX};
+        maxCell_ = Cell{INT32_MIN, INT32_MIN};
+        for (Id id = 0; id < xs_.size(); ++id) {
+            if (!alive_[id]) continue;
+            const Cell& c = cells_[id];
+            items_[cursor[bucketOf(c)]++] = id;
+            minCell_ = Cell{std::min(minCell_.cx, c.cx), std::min(minCell_.cy, c.cy)};
+            maxCell_ = Cell{std::max(maxCell_.cx, c.cx), std::max(maxCell_.cy, c.cy)};
+        }
+
+        for (Id id : pendingList_) pending_[id] = 0;
+        pendingList_.clear();
+    }
+
+    // fn(Id, const Point&) for every point within radius of center
+    template <typename Fn>
+    friend void for_each_within(const SpatialHashGrid& grid, const Point& center, double radius,
+                                Fn fn) {
+        grid.visitWithin(center.x(), center.y(), radius,
+                         [&](Id id) { fn(id, grid.position(id)); });
+    }
+
+    // fn(Id a, Id b) once for every unordered pair closer than radius.
+    // With threads > 1 the bucket table is split into ranges, one per thread,
+    // and fn is called concurrently - it must be thread-safe.
+    template <typename Fn>
+    friend void for_each_pair_within(SpatialHashGrid& grid, double radius, Fn fn,
+                                     unsigned threads = 1) {
+        if (!grid.pendingList_.empty()) grid.rebuild();
+        const SpatialHashGrid& g = grid;
+        const std::size_t buckets = g.bucketMask_ + 1;
+        if (g.items_.empty()) return;
+
+        auto work = [&](std::size_t beginBucket, std::size_t endBucket) {
+            for (std::uint32_t k = g.bucketStart_[beginBucket]; k < g.bucketStart_[endBucket]; ++k) {
+                const Id a = g.items_[k];
+                if (!g.alive_[a]) continue;   // removed since the last rebuild
+                g.visitWithin(g.xs_[a], g.ys_[a], radius, [&](Id b) {
+                    if (a < b) fn(a, b);
+                });
+            }
+        };
+
+        threads = std::max(1u, threads);
+        if (threads == 1) {
+            work(0, buckets);
+            return;
+        }
+        // Many more ranges than threads, handed out dynamically, to absorb dense cells
+        const std::size_t ranges = std::min<std::size_t>(buckets, threads * 16);
+        std::atomic<std::size_t> next{0};
+        auto worker = [&] {
+            for (std::size_t r; (r = next.fetch_add(1)) < ranges;) {
+                work(r * buckets / ranges, (r + 1) * buckets / ranges);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& th : pool) th.join();
+    }
+};
+
+} // namespace geometry
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const double world = 10000.0;
+
+    std::mt19937 rng(57);
+    std::uniform_real_distribution<double> coord(0.0, world);
+    std::normal_distribution<double> jitter(0.0, 1.0);
+
+    geometry::SpatialHashGrid grid(10.0);
+    std::vector<geometry::SpatialHashGrid::Id> ids;
+    std::vector<geometry::Point> truth;
+    ids.reserve(n);
+    truth.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        geometry::Point p(coord(rng), coord(rng));
+        ids.push_back(grid.insert(p));
+        truth.push_back(p);
+    }
+    grid.rebuild();
+
+    // One simulation tick: every point moves a little
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        geometry::Point p(truth[i].x() + jitter(rng), truth[i].y() + jitter(rng));
+        truth[i] = p;
+        grid.move(ids[i], p);
+    }
+    auto t1 = Clock::now();
+    double tickMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    std::cout << "Moved " << n << " points in " << tickMs << " ms ("
+              << n / (tickMs * 1e3) << " M updates/s, including RNG)\n";
+
+    // Radius query against brute force
+    geometry::Point q(world / 2, world / 2);
+    std::size_t found = 0, expected = 0;
+    for_each_within(grid, q, 25.0, [&](geometry::SpatialHashGrid::Id, const geometry::Point&) {
+        ++found;
+    });
+    for (const auto& p : truth) {
+        if (distance(p, q) <= 25.0) ++expected;
+    }
+    std::cout << "Within 25 of the centre: " << found << " (brute force: " << expected << ")\n";
+
+    // A radius far larger than the world, or a far-off centre, stays O(n)
+    auto t4 = Clock::now();
+    std::size_t everything = 0, none = 0;
+    for_each_within(grid, q, 1e12, [&](geometry::SpatialHashGrid::Id, const geometry::Point&) { ++everything; });
+    for_each_within(grid, geometry::Point(1e300, -1e300), 1e6,
+                    [&](geometry::SpatialHashGrid::Id, const geometry::Point&) { ++none; });
+    auto t5 = Clock::now();
+    std::cout << "Within 1e12: " << everything << " of " << grid.size() << ", near (1e300, -1e300): " << none
+              << " (" << std::chrono::duration<double, std::milli>(t5 - t4).count() << " ms)\n";
+
+    grid.remove(ids[0]);
+    std::cout << "After remove: " << grid.size() << " points\n";
+
+    // A point removed after the last rebuild is in no pair
+    geometry::SpatialHashGrid small(10.0);
+    small.insert(geometry::Point(0.0, 0.0));
+    const auto gone = small.insert(geometry::Point(1.0, 0.0));
+    small.rebuild();
+    small.remove(gone);
+    std::size_t stalePairs = 0;
+    for_each_pair_within(small, 2.0, [&](geometry::SpatialHashGrid::Id, geometry::SpatialHashGrid::Id) {
+        ++stalePairs;
+    });
+    std::cout << "Pairs after removing one of two close points: " << stalePairs << " (expected 0)\n";
+
+    // All pairs closer than 2.0
+    std::atomic<std::size_t> pairs{0};
+    auto t2 = Clock::now();
+    for_each_pair_within(grid, 2.0, [&](geometry::SpatialHashGrid::Id, geometry::SpatialHashGrid::Id) {
+        pairs.fetch_add(1, std::memory_order_relaxed);
+    }, std::max(1u, std::thread::hardware_concurrency()));
+    auto t3 = Clock::now();
+    std::cout << "Pairs within 2.0: " << pairs << " in "
+              << std::chrono::duration<double, std::milli>(t3 - t2).count() << " ms\n";
+
+    return 0;
+}
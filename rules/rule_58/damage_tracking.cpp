@@ -0,0 +1,513 @@
+// Good: Dirty-rectangle rendering for graphics scenes, kept inside the graphics namespace
+// Redrawing every shape because one gauge changed colour makes each frame cost
+// O(scene). Here shapes report what changed and the renderer repaints only
+// that:
+//
+//   Shape:        setters call changed(before), handing the old bounds to the
+//                 ShapeObserver that owns the shape
+//   DamageRegion: the changed bounds, merged into a few disjoint rectangles.
+//                 An incoming rect absorbs every rect it overlaps or forms a
+//                 low-waste union with; if the set is still full, it is
+//                 merged with the existing rect whose union with it wastes
+//                 the least area.
+//   Scene:        owns the shapes, files them in a uniform grid of cells and
+//                 turns each change into damage for the old and new bounds
+//   render():     for each dirty rect, clears it and redraws, clipped, just
+//                 the shapes whose bounds intersect it, in paint order
+//
+// Dirty rects never overlap, so translucent shapes are blended exactly once and
+// the frame is the same as a full redraw. When the damage covers more than
+// half the frame, render() falls back to a full redraw. FrameStats reports the
+// pixels written per frame so the O(change) cost can be checked.
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace graphics {
+    // RGBA8888, red in the lowest-addressed byte
+    class Color32 {
+        std::uint32_t rgba_;
+
+        static constexpr std::uint32_t clamp(int v) {
+            return static_cast<std::uint32_t>(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    public:
+        constexpr Color32() : rgba_(0) {}
+        constexpr Color32(int r, int g, int b, int a = 255)
+            : rgba_(clamp(r) | clamp(g) << 8 | clamp(b) << 16 | clamp(a) << 24) {}
+
+        constexpr int red() const { return rgba_ & 0xff; }
+        constexpr int green() const { return (rgba_ >> 8) & 0xff; }
+        constexpr int blue() const { return (rgba_ >> 16) & 0xff; }
+        constexpr int alpha() const { return rgba_ >> 24; }
+        constexpr std::uint32_t packed() const { return rgba_; }
+    };
+
+    using Color = Color32;
+
+    // Half-open pixel rectangle [x0, x1) x [y0, y1)
+    struct PixelRect {
+        int x0, y0, x1, y1;
+
+        bool empty() const { return x0 >= x1 || y0 >= y1; }
+        std::int64_t area() const { return empty() ? 0 : static_cast<std::int64_t>(x1 - x0) * (y1 - y0); }
+        PixelRect intersect(const PixelRect& o) const {
+            return {std::max(x0, o.x0), std::max(y0, o.y0), std::min(x1, o.x1), std::min(y1, o.y1)};
+        }
+        bool intersects(const PixelRect& o) const { return !intersect(o).empty(); }
+        PixelRect unite(const PixelRect& o) const {
+            return {std::min(x0, o.x0), std::min(y0, o.y0), std::max(x1, o.x1), std::max(y1, o.y1)};
+        }
+        bool operator==(const PixelRect& o) const { return x0 == o.x0 && y0 == o.y0 && x1 == o.x1 && y1 == o.y1; }
+        bool operator!=(const PixelRect& o) const { return !(*this == o); }
+    };
+
+    // Row-major RGBA pixels. Every fill is clipped to clip() and counted.
+    class Canvas {
+        int width_, height_;
+        std::vector<std::uint32_t> pixels_;
+        PixelRect clip_;
+        std::size_t written_ = 0;
+
+        static std::uint32_t mul255(std::uint32_t x, std::uint32_t y) {
+            const std::uint32_t t = x * y + 128;
+            return (t + (t >> 8)) >> 8;
+        }
+
+    public:
+        Canvas(int width, int height)
+            : width_(width), height_(height), pixels_(static_cast<std::size_t>(width) * height, 0),
+              clip_{0, 0, width, height} {}
+
+        PixelRect bounds() const { return {0, 0, width_, height_}; }
+        const PixelRect& clip() const { return clip_; }
+        void setClip(const PixelRect& r) { clip_ = r.intersect(bounds()); }
+
+        std::size_t pixelsWritten() const { return written_; }
+        void resetStats() { written_ = 0; }
+        const std::vector<std::uint32_t>& pixels() const { return pixels_; }
+
+        // Opaque colours overwrite, others are blended src-over
+        void fillSpan(int y, int x0, int x1, Color32 c) {
+            if (y < clip_.y0 || y >= clip_.y1) return;
+            x0 = std::max(x0, clip_.x0);
+            x1 = std::min(x1, clip_.x1);
+            if (x0 >= x1) return;
+            written_ += static_cast<std::size_t>(x1 - x0);
+            std::uint32_t* row = pixels_.data() + static_cast<std::size_t>(y) * width_;
+            const std::uint32_t a = static_cast<std::uint32_t>(c.alpha());
+            if (a == 255) {
+                std::fill(row + x0, row + x1, c.packed());
+                return;
+            }
+            const std::uint32_t src[4] = {mul255(c.red(), a), mul255(c.green(), a), mul255(c.blue(), a), a};
+            for (int x = x0; x < x1; ++x) {
+                std::uint32_t out = 0;
+                for (int k = 0; k < 4; ++k) out |= (src[k] + mul255((row[x] >> (8 * k)) & 0xff, 255 - a)) << (8 * k);
+                row[x] = out;
+            }
+        }
+
+        void fillRect(const PixelRect& r, Color32 c) {
+            const PixelRect area = r.intersect(clip_);
+            for (int y = area.y0; y < area.y1; ++y) fillSpan(y, area.x0, area.x1, c);
+        }
+    };
+
+    class Shape;
+
+    // Told about every visible change to a shape it owns
+    class ShapeObserver {
+    public:
+        virtual void shapeChanged(const Shape& shape, const PixelRect& before) = 0;
+    protected:
+        ~ShapeObserver() = default;
+    };
+
+    class Shape {
+        friend class Scene;
+        ShapeObserver* observer_ = nullptr;
+        std::uint32_t id_ = 0;
+    protected:
+        Color color_;
+
+        // Call after any change that affects the pixels, with the bounds before it
+        void changed(const PixelRect& before) {
+            if (observer_) observer_->shapeChanged(*this, before);
+        }
+    public:
+        Shape(const Color& c) : color_(c) {}
+        Shape(const Shape&) = delete;
+        Shape& operator=(const Shape&) = delete;
+        virtual ~Shape() = default;
+
+        // Pixels draw() may touch
+        virtual PixelRect bounds() const = 0;
+        // Draws the shape, clipped to canvas.clip()
+        virtual void draw(Canvas& canvas) const = 0;
+
+        const Color& color() const { return color_; }
+        void setColor(const Color& c) {
+            if (c.packed() == color_.packed()) return;
+            color_ = c;
+            changed(bounds());
+        }
+    };
+
+    class Rect final : public Shape {
+        PixelRect r_;
+    public:
+        Rect(const Color& c, const PixelRect& r) : Shape(c), r_(r) {}
+        PixelRect bounds() const override { return r_; }
+        void draw(Canvas& canvas) const override { canvas.fillRect(r_, color_); }
+
+        void setRect(const PixelRect& r) {
+            const PixelRect before = r_;
+            r_ = r;
+            changed(before);
+        }
+    };
+
+    // Covers the pixels whose centres lie inside the circle
+    class Circle final : public Shape {
+        float cx_, cy_, r_;
+    public:
+        Circle(const Color& c, float cx, float cy, float r) : Shape(c), cx_(cx), cy_(cy), r_(r) {}
+        PixelRect bounds() const override {
+            return {static_cast<int>(std::floor(cx_ - r_)), static_cast<int>(std::floor(cy_ - r_)),
+                    static_cast<int>(std::ceil(cx_ + r_)) + 1, static_cast<int>(std::ceil(cy_ + r_)) + 1};
+        }
+        void draw(Canvas& canvas) const override {
+            const PixelRect area = bounds().intersect(canvas.clip());
+            for (int y = area.y0; y < area.y1; ++y) {
+                const float dy = y + 0.5f - cy_, h2 = r_ * r_ - dy * dy;
+                if (h2 < 0.0f) continue;
+                const float half = std::sqrt(h2);
+                canvas.fillSpan(y, static_cast<int>(std::ceil(cx_ - half - 0.5f)),
+                                static_cast<int>(std::floor(cx_ + half - 0.5f)) + 1, color_);
+            }
+        }
+
+        void moveTo(float cx, float cy) {
+            const PixelRect before = bounds();
+            cx_ = cx;
+            cy_ = cy;
+            changed(before);
+        }
+    };
+
+    void render(const Shape& shape, Canvas& canvas) {
+        shape.draw(canvas);
+    }
+
+    // A small set of disjoint rectangles covering every area added to it
+    class DamageRegion {
+        std::vector<PixelRect> rects_;
+        std::size_t maxRects_;
+
+        // Area redrawn for nothing if a and b are repainted as their union
+        static std::int64_t waste(const PixelRect& a, const PixelRect& b) {
+            return a.unite(b).area() - a.area() - b.area() + a.intersect(b).area();
+        }
+
+    public:
+        explicit DamageRegion(std::size_t maxRects = 16) : rects_(), maxRects_(std::max<std::size_t>(maxRects, 1)) {}
+
+        const std::vector<PixelRect>& rects() const { return rects_; }
+        bool empty() const { return rects_.empty(); }
+        void clear() { rects_.clear(); }
+
+        std::int64_t area() const {
+            std::int64_t a = 0;
+            for (const PixelRect& r : rects_) a += r.area();
+            return a;
+        }
+
+        // Merges r with every rect it overlaps or nearly fills a union with;
+        // when the set is full, also with the rect that wastes the least
+        void add(PixelRect r) {
+            if (r.empty()) return;
+            for (;;) {
+                auto it = std::find_if(rects_.begin(), rects_.end(), [&](const PixelRect& d) {
+                    return d.intersects(r) || 4 * waste(d, r) <= d.area() + r.area();
+                });
+                if (it == rects_.end()) {
+                    if (rects_.size() < maxRects_) break;
+                    it = std::min_element(rects_.begin(), rects_.end(), [&](const PixelRect& a, const PixelRect& b) {
+                        return waste(a, r) < waste(b, r);
+                    });
+                }
+                r = r.unite(*it);
+                *it = rects_.back();
+                rects_.pop_back();
+            }
+            rects_.push_back(r);
+        }
+    };
+
+    // What one render() call did
+    struct FrameStats {
+        bool fullRedraw = false;
+        std::size_t dirtyRects = 0;
+        std::int64_t dirtyPixels = 0;
+        std::size_t shapesDrawn = 0;
+        std::size_t pixelsWritten = 0;
+    };
+
+    // Shapes in paint order, a grid index over their bounds and the damage
+    // accumulated since the last render()
+    class Scene final : private ShapeObserver {
+        static constexpr int cellSize = 64;
+
+        int width_, height_;
+        Color32 background_;
+        std::vector<std::unique_ptr<Shape>> shapes_;
+        std::vector<PixelRect> indexed_;                  // bounds each shape is filed under
+        int cellsX_, cellsY_;
+        std::vector<std::vector<std::uint32_t>> cells_;   // shape ids per cell, unordered
+        DamageRegion damage_;
+        bool fullDamage_ = true;
+        std::vector<std::uint32_t> seen_;
+        std::uint32_t stamp_ = 0;
+
+        // Cell columns [x0, x1) and rows [y0, y1) touched by r
+        PixelRect cellSpan(PixelRect r) const {
+            r = r.intersect({0, 0, width_, height_});
+            if (r.empty()) return {0, 0, 0, 0};
+            return {r.x0 / cellSize, r.y0 / cellSize, (r.x1 - 1) / cellSize + 1, (r.y1 - 1) / cellSize + 1};
+        }
+
+        void file(std::uint32_t id) {
+            const PixelRect span = cellSpan(indexed_[id]);
+            for (int cy = span.y0; cy < span.y1; ++cy) {
+                for (int cx = span.x0; cx < span.x1; ++cx) cells_[cy * cellsX_ + cx].push_back(id);
+            }
+        }
+
+        void unfile(std::uint32_t id) {
+            const PixelRect span = cellSpan(indexed_[id]);
+            for (int cy = span.y0; cy < span.y1; ++cy) {
+                for (int cx = span.x0; cx < span.x1; ++cx) {
+                    std::vector<std::uint32_t>& cell = cells_[cy * cellsX_ + cx];
+                    *std::find(cell.begin(), cell.end(), id) = cell.back();
+                    cell.pop_back();
+                }
+            }
+        }
+
+        void shapeChanged(const Shape& shape, const PixelRect& before) override {
+            const PixelRect now = shape.bounds();
+            invalidate(before);
+            invalidate(now);
+            if (now != indexed_[shape.id_]) {
+                unfile(shape.id_);
+                indexed_[shape.id_] = now;
+                file(shape.id_);
+            }
+        }
+
+    public:
+        Scene(int width, int height, Color32 background, std::size_t maxDirtyRects = 16)
+            : width_(width), height_(height), background_(background),
+              cellsX_((width + cellSize - 1) / cellSize), cellsY_((height + cellSize - 1) / cellSize),
+              cells_(static_cast<std::size_t>(cellsX_) * cellsY_), damage_(maxDirtyRects) {}
+
+        ~Scene() {
+            for (auto& shape : shapes_) shape->observer_ = nullptr;
+        }
+
+        Scene(const Scene&) = delete;
+        Scene& operator=(const Scene&) = delete;
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+        Color32 background() const { return background_; }
+        std::size_t size() const { return shapes_.size(); }
+        const Shape& operator[](std::size_t i) const { return *shapes_[i]; }
+
+        // Appends shape on top of the others
+        template <typename T>
+        T& add(std::unique_ptr<T> shape) {
+            T& ref = *shape;
+            ref.observer_ = this;
+            ref.id_ = static_cast<std::uint32_t>(shapes_.size());
+            shapes_.push_back(std::move(shape));
+            indexed_.push_back(ref.bounds());
+            seen_.push_back(stamp_);
+            file(ref.id_);
+            invalidate(ref.bounds());
+            return ref;
+        }
+
+        template <typename T, typename... Args>
+        T& emplace(Args&&... args) {
+            return add(std::make_unique<T>(std::forward<Args>(args)...));
+        }
+
+        void invalidate(const PixelRect& r) {
+            if (fullDamage_) return;
+            damage_.add(r.intersect({0, 0, width_, height_}));
+            if (2 * damage_.area() > static_cast<std::int64_t>(width_) * height_) invalidateAll();
+        }
+
+        void invalidateAll() {
+            fullDamage_ = true;
+            damage_.clear();
+        }
+
+        bool fullyDamaged() const { return fullDamage_; }
+        const DamageRegion& damage() const { return damage_; }
+
+        // Ids of the shapes whose bounds intersect r, in paint order
+        void query(const PixelRect& r, std::vector<std::uint32_t>& out) {
+            out.clear();
+            if (++stamp_ == 0) {
+                std::fill(seen_.begin(), seen_.end(), 0u);
+                stamp_ = 1;
+            }
+            const PixelRect span = cellSpan(r);
+            for (int cy = span.y0; cy < span.y1; ++cy) {
+                for (int cx = span.x0; cx < span.x1; ++cx) {
+                    for (std::uint32_t id : cells_[cy * cellsX_ + cx]) {
+                        if (seen_[id] == stamp_ || !indexed_[id].intersects(r)) continue;
+                        seen_[id] = stamp_;
+                        out.push_back(id);
+                    }
+                }
+            }
+            std::sort(out.begin(), out.end());
+        }
+
+        void markRendered() {
+            fullDamage_ = false;
+            damage_.clear();
+        }
+    };
+
+    // Every shape, whatever the damage; leaves the damage untouched
+    FrameStats redraw(const Scene& scene, Canvas& canvas) {
+        FrameStats stats;
+        canvas.resetStats();
+        canvas.setClip(canvas.bounds());
+        canvas.fillRect(canvas.bounds(), scene.background());
+        for (std::size_t i = 0; i < scene.size(); ++i) render(scene[i], canvas);
+        stats.fullRedraw = true;
+        stats.dirtyRects = 1;
+        stats.dirtyPixels = canvas.bounds().area();
+        stats.shapesDrawn = scene.size();
+        stats.pixelsWritten = canvas.pixelsWritten();
+        return stats;
+    }
+
+    // Repaints what changed since the last render() of this scene onto canvas
+    FrameStats render(Scene& scene, Canvas& canvas) {
+        if (scene.fullyDamaged()) {
+            const FrameStats stats = redraw(scene, canvas);
+            scene.markRendered();
+            return stats;
+        }
+        FrameStats stats;
+        canvas.resetStats();
+        std::vector<std::uint32_t> ids;
+        for (const PixelRect& dirty : scene.damage().rects()) {
+            canvas.setClip(dirty);
+            canvas.fillRect(dirty, scene.background());
+            scene.query(dirty, ids);
+            for (std::uint32_t id : ids) render(scene[id], canvas);
+            stats.shapesDrawn += ids.size();
+            stats.dirtyPixels += dirty.area();
+        }
+        stats.dirtyRects = scene.damage().rects().size();
+        stats.pixelsWritten = canvas.pixelsWritten();
+        canvas.setClip(canvas.bounds());
+        scene.markRendered();
+        return stats;
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const int width = 1920, height = 1080, frames = 60;
+
+    // A dashboard: opaque panels, then many small widgets, some translucent
+    std::mt19937 rng(58);
+    graphics::Scene scene(width, height, graphics::Color(240, 240, 240));
+    for (int py = 0; py < 4; ++py) {
+        for (int px = 0; px < 6; ++px) {
+            scene.emplace<graphics::Rect>(graphics::Color(40 + 10 * px, 40 + 10 * py, 60),
+                                          graphics::PixelRect{px * 320 + 8, py * 270 + 8, px * 320 + 312, py * 270 + 262});
+        }
+    }
+    std::uniform_real_distribution<float> x(0.0f, width), y(0.0f, height), size(2.0f, 12.0f);
+    std::uniform_int_distribution<int> channel(0, 255), alpha(64, 255);
+    std::vector<graphics::Rect*> gauges;
+    std::vector<graphics::Circle*> markers;
+    for (std::size_t i = 0; i < n; ++i) {
+        const graphics::Color c(channel(rng), channel(rng), channel(rng), (i % 4) ? 255 : alpha(rng));
+        const float s = size(rng);
+        if (i % 2) {
+            markers.push_back(&scene.emplace<graphics::Circle>(c, x(rng), y(rng), s / 2));
+        } else {
+            const int x0 = static_cast<int>(x(rng)), y0 = static_cast<int>(y(rng));
+            gauges.push_back(&scene.emplace<graphics::Rect>(
+                c, graphics::PixelRect{x0, y0, x0 + static_cast<int>(s), y0 + static_cast<int>(s)}));
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    graphics::Canvas incremental(width, height), reference(width, height);
+    const graphics::FrameStats first = render(scene, incremental);
+
+    // Each frame a few gauges change colour and a few markers move
+    std::uniform_int_distribution<std::size_t> pickGauge(0, gauges.size() - 1), pickMarker(0, markers.size() - 1);
+    std::uniform_real_distribution<float> step(-4.0f, 4.0f);
+    std::vector<std::pair<float, float>> positions;
+    double fullTime = 0.0, damageTime = 0.0, fullPixels = 0.0, damagePixels = 0.0, rects = 0.0, drawn = 0.0;
+    bool identical = true;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int k = 0; k < 10; ++k) {
+            gauges[pickGauge(rng)]->setColor(graphics::Color(channel(rng), channel(rng), channel(rng)));
+        }
+        for (int k = 0; k < 3; ++k) {
+            graphics::Circle& m = *markers[pickMarker(rng)];
+            const graphics::PixelRect b = m.bounds();
+            m.moveTo((b.x0 + b.x1 - 1) / 2.0f + step(rng), (b.y0 + b.y1 - 1) / 2.0f + step(rng));
+        }
+
+        auto t0 = Clock::now();
+        const graphics::FrameStats full = redraw(scene, reference);
+        auto t1 = Clock::now();
+        const graphics::FrameStats damage = render(scene, incremental);
+        auto t2 = Clock::now();
+
+        fullTime += ms(t1 - t0);
+        damageTime += ms(t2 - t1);
+        fullPixels += static_cast<double>(full.pixelsWritten);
+        damagePixels += static_cast<double>(damage.pixelsWritten);
+        rects += static_cast<double>(damage.dirtyRects);
+        drawn += static_cast<double>(damage.shapesDrawn);
+        identical = identical && incremental.pixels() == reference.pixels();
+    }
+
+    std::cout << scene.size() << " shapes on " << width << "x" << height << ", first frame "
+              << first.pixelsWritten << " pixels written\n";
+    std::cout << "Per frame over " << frames << " frames (10 recolours, 3 moves):\n";
+    std::cout << "  full redraw:  " << fullTime / frames << " ms, " << fullPixels / frames << " pixels written, "
+              << scene.size() << " shapes\n";
+    std::cout << "  damage only:  " << damageTime / frames << " ms, " << damagePixels / frames << " pixels written, "
+              << drawn / frames << " shapes in " << rects / frames << " dirty rects\n";
+    std::cout << "  frames identical to full redraw: " << (identical ? "yes" : "no") << "\n";
+
+    return 0;
+}
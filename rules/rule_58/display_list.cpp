@@ -0,0 +1,435 @@
+// Good: Recorded display lists for graphics scenes, kept in the graphics namespace
+// A mostly static scene still pays, every frame, for walking its Shape objects
+// and calling draw() through the vtable. A DisplayList records what draw()
+// emits once, as fixed-layout commands in one linear byte buffer, and replay()
+// runs that buffer with a switch: no virtual calls, no allocation, one
+// streaming pass.
+//
+// Shapes describe themselves through a CommandSink. Drawing immediately passes
+// the Canvas itself as the sink; recording passes a sink that appends to the
+// list. Each recorded shape owns a slot in the buffer, so a changed shape can
+// be re-recorded on its own without touching the rest: commands that still fit
+// the slot are written in place (padded with a skip), and commands that outgrow
+// it go to an overflow area that the slot calls into and returns from. Paint
+// order never changes and nothing is shifted; dead overflow blocks are
+// compacted away once they make up half of the overflow area.
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace graphics {
+    // RGBA8888, red in the lowest-addressed byte
+    class Color32 {
+        std::uint32_t rgba_;
+
+        static constexpr std::uint32_t clamp(int v) {
+            return static_cast<std::uint32_t>(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    public:
+        constexpr Color32() : rgba_(0) {}
+        constexpr Color32(int r, int g, int b, int a = 255)
+            : rgba_(clamp(r) | clamp(g) << 8 | clamp(b) << 16 | clamp(a) << 24) {}
+
+        static constexpr Color32 fromPacked(std::uint32_t rgba) {
+            Color32 c;
+            c.rgba_ = rgba;
+            return c;
+        }
+
+        constexpr int red() const { return rgba_ & 0xff; }
+        constexpr int green() const { return (rgba_ >> 8) & 0xff; }
+        constexpr int blue() const { return (rgba_ >> 16) & 0xff; }
+        constexpr int alpha() const { return rgba_ >> 24; }
+        constexpr std::uint32_t packed() const { return rgba_; }
+    };
+
+    using Color = Color32;
+
+    // Everything a shape can ask to have drawn
+    class CommandSink {
+    public:
+        virtual void fillRect(int x0, int y0, int x1, int y1, Color32 c) = 0;
+        virtual void fillCircle(float cx, float cy, float r, Color32 c) = 0;
+    protected:
+        ~CommandSink() = default;
+    };
+
+    // Row-major RGBA pixels; opaque colours overwrite, others are blended src-over
+    class Canvas final : public CommandSink {
+        int width_, height_;
+        std::vector<std::uint32_t> pixels_;
+
+        static std::uint32_t mul255(std::uint32_t x, std::uint32_t y) {
+            const std::uint32_t t = x * y + 128;
+            return (t + (t >> 8)) >> 8;
+        }
+
+        void span(int y, int x0, int x1, Color32 c) {
+            if (y < 0 || y >= height_) return;
+            x0 = std::max(x0, 0);
+            x1 = std::min(x1, width_);
+            std::uint32_t* row = pixels_.data() + static_cast<std::size_t>(y) * width_;
+            const std::uint32_t a = static_cast<std::uint32_t>(c.alpha());
+            if (a == 255) {
+                std::fill(row + std::min(x0, x1), row + x1, c.packed());
+                return;
+            }
+            const std::uint32_t src[4] = {mul255(c.red(), a), mul255(c.green(), a), mul255(c.blue(), a), a};
+            for (int x = x0; x < x1; ++x) {
+                std::uint32_t out = 0;
+                for (int k = 0; k < 4; ++k) out |= (src[k] + mul255((row[x] >> (8 * k)) & 0xff, 255 - a)) << (8 * k);
+                row[x] = out;
+            }
+        }
+
+    public:
+        Canvas(int width, int height)
+            : width_(width), height_(height), pixels_(static_cast<std::size_t>(width) * height, 0) {}
+
+        void clear(Color32 c) { std::fill(pixels_.begin(), pixels_.end(), c.packed()); }
+        const std::vector<std::uint32_t>& pixels() const { return pixels_; }
+
+        void fillRect(int x0, int y0, int x1, int y1, Color32 c) override {
+            for (int y = std::max(y0, 0); y < std::min(y1, height_); ++y) span(y, x0, x1, c);
+        }
+
+        // Pixels whose centres lie inside the circle
+        void fillCircle(float cx, float cy, float r, Color32 c) override {
+            const int y0 = static_cast<int>(std::floor(cy - r)), y1 = static_cast<int>(std::ceil(cy + r)) + 1;
+            for (int y = std::max(y0, 0); y < std::min(y1, height_); ++y) {
+                const float dy = y + 0.5f - cy, h2 = r * r - dy * dy;
+                if (h2 < 0.0f) continue;
+                const float half = std::sqrt(h2);
+                span(y, static_cast<int>(std::ceil(cx - half - 0.5f)), static_cast<int>(std::floor(cx + half - 0.5f)) + 1, c);
+            }
+        }
+    };
+
+    class Shape {
+    protected:
+        Color color_;
+    public:
+        Shape(const Color& c) : color_(c) {}
+        virtual void draw(CommandSink& sink) const = 0;
+        virtual ~Shape() = default;
+
+        void setColor(const Color& c) { color_ = c; }
+    };
+
+    class Rect final : public Shape {
+        int x0_, y0_, x1_, y1_;
+    public:
+        Rect(const Color& c, int x0, int y0, int x1, int y1) : Shape(c), x0_(x0), y0_(y0), x1_(x1), y1_(y1) {}
+        void draw(CommandSink& sink) const override { sink.fillRect(x0_, y0_, x1_, y1_, color_); }
+    };
+
+    class Circle final : public Shape {
+        float cx_, cy_, r_;
+    public:
+        Circle(const Color& c, float cx, float cy, float r) : Shape(c), cx_(cx), cy_(cy), r_(r) {}
+        void draw(CommandSink& sink) const override { sink.fillCircle(cx_, cy_, r_, color_); }
+    };
+
+    // A status marker: a plate with a dot on it, two commands
+    class Badge final : public Shape {
+        int x_, y_;
+        bool on_;
+    public:
+        Badge(const Color& c, int x, int y, bool on) : Shape(c), x_(x), y_(y), on_(on) {}
+        void setOn(bool on) { on_ = on; }
+        void draw(CommandSink& sink) const override {
+            sink.fillRect(x_, y_, x_ + 12, y_ + 8, Color(40, 40, 40));
+            if (on_) sink.fillCircle(x_ + 6.0f, y_ + 4.0f, 3.0f, color_);
+        }
+    };
+
+    // Function that works with graphics types
+    void render(const Shape& shape, Canvas& canvas) {
+        shape.draw(canvas);
+    }
+
+    class DisplayList {
+    public:
+        using SegmentId = std::uint32_t;
+
+        // Appends s's commands as a new segment, drawn after all earlier ones
+        SegmentId record(const Shape& s) {
+            Segment seg;
+            seg.slot = buffer_.size();
+            Recorder recorder{buffer_};
+            s.draw(recorder);
+            const std::size_t used = buffer_.size() - seg.slot;
+            seg.slotSize = std::max(used, callSize);     // always room to redirect the slot
+            buffer_.resize(seg.slot + seg.slotSize);
+            pad(buffer_.data() + seg.slot + used, seg.slotSize - used);
+            segments_.push_back(seg);
+            return static_cast<SegmentId>(segments_.size() - 1);
+        }
+
+        // Replaces segment id with s's current commands, keeping its place in
+        // paint order. Commands that fit the segment's slot are written there;
+        // larger ones move to the overflow area and the slot calls them.
+        void rerecord(SegmentId id, const Shape& s) {
+            Segment& seg = segments_[id];
+            scratch_.clear();
+            Recorder recorder{scratch_};
+            s.draw(recorder);
+
+            unsigned char* slot = buffer_.data() + seg.slot;
+            if (scratch_.size() <= seg.slotSize) {
+                std::memcpy(slot, scratch_.data(), scratch_.size());
+                pad(slot + scratch_.size(), seg.slotSize - scratch_.size());
+                releaseOverflow(seg);
+                return;
+            }
+            if (seg.overflow != none && scratch_.size() + headerSize <= seg.overflowSize) {
+                writeOverflow(seg.overflow);
+                return;
+            }
+            releaseOverflow(seg);
+            seg.overflow = overflow_.size();
+            seg.overflowSize = scratch_.size() + headerSize;
+            overflow_.resize(overflow_.size() + seg.overflowSize);
+            writeOverflow(seg.overflow);
+            writeCall(seg);
+            if (overflowGarbage_ > 65536 && overflowGarbage_ > overflow_.size() / 2) compactOverflow();
+        }
+
+        void clear() {
+            buffer_.clear();
+            overflow_.clear();
+            segments_.clear();
+            overflowGarbage_ = 0;
+        }
+
+        std::size_t segments() const { return segments_.size(); }
+        std::size_t bytes() const { return buffer_.size() + overflow_.size(); }
+
+        friend void replay(const DisplayList& list, Canvas& canvas);
+
+    private:
+        // Every command is a 4-byte header (opcode | payload length << 8)
+        // followed by its payload
+        enum Op : std::uint8_t { fillRectOp, fillCircleOp, skipOp, callOp, returnOp };
+
+        struct FillRect {
+            std::int32_t x0, y0, x1, y1;
+            std::uint32_t color;
+        };
+        struct FillCircle {
+            float cx, cy, r;
+            std::uint32_t color;
+        };
+
+        struct Segment {
+            std::size_t slot = 0, slotSize = 0;
+            std::size_t overflow = none, overflowSize = 0;
+        };
+
+        static constexpr std::size_t none = static_cast<std::size_t>(-1);
+        static constexpr std::size_t headerSize = 4;
+        static constexpr std::size_t callSize = headerSize + sizeof(std::uint64_t);
+
+        static void putHeader(unsigned char* at, Op op, std::size_t length) {
+            const std::uint32_t header = op | static_cast<std::uint32_t>(length) << 8;
+            std::memcpy(at, &header, headerSize);
+        }
+
+        // Fills bytes [at, at + size) with one skip command
+        static void pad(unsigned char* at, std::size_t size) {
+            if (size >= headerSize) putHeader(at, skipOp, size - headerSize);
+        }
+
+        class Recorder final : public CommandSink {
+            std::vector<unsigned char>& out_;
+
+            template <typename Payload>
+            void append(Op op, const Payload& payload) {
+                const std::size_t at = out_.size();
+                out_.resize(at + headerSize + sizeof(Payload));
+                putHeader(out_.data() + at, op, sizeof(Payload));
+                std::memcpy(out_.data() + at + headerSize, &payload, sizeof(Payload));
+            }
+
+        public:
+            explicit Recorder(std::vector<unsigned char>& out) : out_(out) {}
+
+            void fillRect(int x0, int y0, int x1, int y1, Color32 c) override {
+                append(fillRectOp, FillRect{x0, y0, x1, y1, c.packed()});
+            }
+            void fillCircle(float cx, float cy, float r, Color32 c) override {
+                append(fillCircleOp, FillCircle{cx, cy, r, c.packed()});
+            }
+        };
+
+        // scratch_ followed by a return, at overflow offset at
+        void writeOverflow(std::size_t at) {
+            std::memcpy(overflow_.data() + at, scratch_.data(), scratch_.size());
+            putHeader(overflow_.data() + at + scratch_.size(), returnOp, 0);
+        }
+
+        void writeCall(const Segment& seg) {
+            unsigned char* slot = buffer_.data() + seg.slot;
+            const std::uint64_t target = seg.overflow;
+            putHeader(slot, callOp, sizeof(target));
+            std::memcpy(slot + headerSize, &target, sizeof(target));
+            pad(slot + callSize, seg.slotSize - callSize);
+        }
+
+        void releaseOverflow(Segment& seg) {
+            if (seg.overflow == none) return;
+            overflowGarbage_ += seg.overflowSize;
+            seg.overflow = none;
+            seg.overflowSize = 0;
+        }
+
+        // Drops overflow blocks no segment calls any more
+        void compactOverflow() {
+            std::vector<unsigned char> live;
+            live.reserve(overflow_.size() - overflowGarbage_);
+            for (Segment& seg : segments_) {
+                if (seg.overflow == none) continue;
+                const std::size_t at = live.size();
+                live.insert(live.end(), overflow_.begin() + seg.overflow,
+                            overflow_.begin() + seg.overflow + seg.overflowSize);
+                seg.overflow = at;
+                writeCall(seg);
+            }
+            overflow_.swap(live);
+            overflowGarbage_ = 0;
+        }
+
+        std::vector<unsigned char> buffer_;        // one slot per segment, in paint order
+        std::vector<unsigned char> overflow_;      // segments that outgrew their slot
+        std::vector<Segment> segments_;
+        std::vector<unsigned char> scratch_;       // reused by rerecord
+        std::size_t overflowGarbage_ = 0;
+    };
+
+    // Executes every recorded command in order
+    void replay(const DisplayList& list, Canvas& canvas) {
+        const unsigned char* p = list.buffer_.data();
+        const unsigned char* end = p + list.buffer_.size();
+        const unsigned char* resume = nullptr;
+        while (p < end) {
+            std::uint32_t header;
+            std::memcpy(&header, p, sizeof(header));
+            const unsigned char* payload = p + DisplayList::headerSize;
+            p = payload + (header >> 8);
+            switch (static_cast<DisplayList::Op>(header & 0xff)) {
+            case DisplayList::fillRectOp: {
+                DisplayList::FillRect c;
+                std::memcpy(&c, payload, sizeof(c));
+                canvas.fillRect(c.x0, c.y0, c.x1, c.y1, Color32::fromPacked(c.color));
+                break;
+            }
+            case DisplayList::fillCircleOp: {
+                DisplayList::FillCircle c;
+                std::memcpy(&c, payload, sizeof(c));
+                canvas.fillCircle(c.cx, c.cy, c.r, Color32::fromPacked(c.color));
+                break;
+            }
+            case DisplayList::skipOp:
+                break;
+            case DisplayList::callOp: {
+                std::uint64_t target;
+                std::memcpy(&target, payload, sizeof(target));
+                resume = p;
+                p = list.overflow_.data() + target;
+                end = list.overflow_.data() + list.overflow_.size();
+                break;
+            }
+            case DisplayList::returnOp:
+                p = resume;
+                end = list.buffer_.data() + list.buffer_.size();
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    const int width = 1920, height = 1080;
+
+    // A dashboard: many small marks, some badges that toggle between frames
+    std::mt19937 rng(58);
+    std::uniform_int_distribution<int> x(0, width - 1), y(0, height - 1), channel(0, 255), side(1, 4);
+    std::vector<std::unique_ptr<graphics::Shape>> scene;
+    for (std::size_t i = 0; i < n; ++i) {
+        const graphics::Color c(channel(rng), channel(rng), channel(rng), (i % 4) ? 255 : 160);
+        if (i % 100 == 0) {
+            scene.push_back(std::make_unique<graphics::Badge>(graphics::Color(0, 200, 0), x(rng), y(rng), true));
+        } else if (i % 2) {
+            const int x0 = x(rng), y0 = y(rng);
+            scene.push_back(std::make_unique<graphics::Rect>(c, x0, y0, x0 + side(rng), y0 + side(rng)));
+        } else {
+            scene.push_back(std::make_unique<graphics::Circle>(c, x(rng) + 0.5f, y(rng) + 0.5f, side(rng) * 0.5f));
+        }
+    }
+    // A long-lived scene's paint order has little to do with allocation order
+    std::shuffle(scene.begin(), scene.end(), rng);
+    std::vector<std::size_t> badges;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (dynamic_cast<graphics::Badge*>(scene[i].get())) badges.push_back(i);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    const int frames = 10;
+
+    graphics::Canvas immediate(width, height), replayed(width, height);
+    graphics::DisplayList list;
+    auto t0 = Clock::now();
+    for (const auto& shape : scene) list.record(*shape);
+    auto t1 = Clock::now();
+
+    double immediateMs = 0.0, replayMs = 0.0, rerecordMs = 0.0;
+    bool identical = true;
+    for (int frame = 0; frame < frames; ++frame) {
+        // Between frames a few badges flip, changing their segment size
+        // and colour; the list re-records only those shapes
+        auto t2 = Clock::now();
+        for (std::size_t b = frame; b < badges.size(); b += 50) {
+            graphics::Badge& badge = static_cast<graphics::Badge&>(*scene[badges[b]]);
+            badge.setOn(frame % 2 == 0);
+            badge.setColor(graphics::Color(200, frame * 20, 0));
+            list.rerecord(static_cast<graphics::DisplayList::SegmentId>(badges[b]), badge);
+        }
+        auto t3 = Clock::now();
+
+        immediate.clear(graphics::Color(255, 255, 255));
+        auto t4 = Clock::now();
+        for (const auto& shape : scene) render(*shape, immediate);  // ADL
+        auto t5 = Clock::now();
+
+        replayed.clear(graphics::Color(255, 255, 255));
+        auto t6 = Clock::now();
+        replay(list, replayed);
+        auto t7 = Clock::now();
+
+        rerecordMs += ms(t3 - t2);
+        immediateMs += ms(t5 - t4);
+        replayMs += ms(t7 - t6);
+        identical = identical && immediate.pixels() == replayed.pixels();
+    }
+
+    std::cout << n << " shapes, " << list.bytes() / 1024 << " KiB display list (recorded in " << ms(t1 - t0)
+              << " ms)\n";
+    std::cout << "Per frame over " << frames << " frames:\n";
+    std::cout << "  immediate draw():  " << immediateMs / frames << " ms\n";
+    std::cout << "  replay():          " << replayMs / frames << " ms\n";
+    std::cout << "  rerecord changes:  " << rerecordMs / frames << " ms\n";
+    std::cout << "  replayed frames identical to immediate: " << (identical ? "yes" : "no") << "\n";
+
+    return 0;
+}
@@ -0,0 +1,389 @@
+// Good: A tiled software rasterizer behind graphics::render, all inside the graphics namespace
+// render() used to call draw() with nowhere to draw to. Here a Framebuffer is
+// the output target, and drawing a scene is split into tiles:
+//
+//   Framebuffer: pixels stored tile by tile (64x64 packed RGBA each), so a
+//                tile is one contiguous 16 KiB block and no two threads ever
+//                share a cache line of pixels
+//   binning:     every shape is appended to the bins of the tiles its bounds
+//                touch, in submission order. Threads count and fill bins for
+//                contiguous shape ranges and the bins are laid out tile-major,
+//                thread-minor, so order is preserved without any locking.
+//   rasterizing: each worker owns a range of tiles and takes from its front;
+//                an idle worker steals from the back of another's range with a
+//                compare-and-swap. A tile belongs to exactly one worker, so
+//                pixel writes need no synchronization at all.
+//
+// Within a tile, shapes are drawn in submission order, so the image is the
+// same as drawing every shape in turn on one thread.
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace graphics {
+    // RGBA8888, red in the lowest-addressed byte
+    class Color32 {
+        std::uint32_t rgba_;
+
+        static constexpr std::uint32_t clamp(int v) {
+            return static_cast<std::uint32_t>(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    public:
+        constexpr Color32() : rgba_(0) {}
+        constexpr Color32(int r, int g, int b, int a = 255)
+            : rgba_(clamp(r) | clamp(g) << 8 | clamp(b) << 16 | clamp(a) << 24) {}
+
+        constexpr int red() const { return rgba_ & 0xff; }
+        constexpr int green() const { return (rgba_ >> 8) & 0xff; }
+        constexpr int blue() const { return (rgba_ >> 16) & 0xff; }
+        constexpr int alpha() const { return rgba_ >> 24; }
+        constexpr std::uint32_t packed() const { return rgba_; }
+    };
+
+    using Color = Color32;
+
+    // Half-open pixel rectangle [x0, x1) x [y0, y1)
+    struct PixelRect {
+        int x0, y0, x1, y1;
+
+        bool empty() const { return x0 >= x1 || y0 >= y1; }
+        PixelRect intersect(const PixelRect& o) const {
+            return {std::max(x0, o.x0), std::max(y0, o.y0), std::min(x1, o.x1), std::min(y1, o.y1)};
+        }
+    };
+
+    namespace detail {
+        constexpr std::uint32_t mul255(std::uint32_t x, std::uint32_t y) {
+            const std::uint32_t t = x * y + 128;
+            return (t + (t >> 8)) >> 8;
+        }
+    }
+
+    // One tile's pixels as handed to Shape::draw; only pixels inside rect exist
+    class Tile {
+        PixelRect rect_;
+        std::uint32_t* pixels_;   // tileSize x tileSize, row-major
+    public:
+        static constexpr int tileSize = 64;
+
+        Tile(const PixelRect& rect, std::uint32_t* pixels) : rect_(rect), pixels_(pixels) {}
+
+        const PixelRect& rect() const { return rect_; }
+
+        // Src-over of a solid colour onto pixels [x0, x1) of row y, clipped to the tile
+        void blendSpan(int y, int x0, int x1, Color32 color) {
+            if (y < rect_.y0 || y >= rect_.y1) return;
+            x0 = std::max(x0, rect_.x0);
+            x1 = std::min(x1, rect_.x1);
+            if (x0 >= x1) return;
+            std::uint32_t* row = pixels_ + (y - rect_.y0) * tileSize - rect_.x0;
+            const std::uint32_t a = static_cast<std::uint32_t>(color.alpha());
+            if (a == 255) {
+                std::fill(row + x0, row + x1, color.packed());
+                return;
+            }
+            // Premultiply the source once per span
+            const std::uint32_t src[4] = {detail::mul255(color.red(), a), detail::mul255(color.green(), a),
+                                          detail::mul255(color.blue(), a), a};
+            const std::uint32_t inv = 255 - a;
+            for (int x = x0; x < x1; ++x) {
+                const std::uint32_t d = row[x];
+                std::uint32_t out = 0;
+                for (int c = 0; c < 4; ++c) {
+                    out |= (src[c] + detail::mul255((d >> (8 * c)) & 0xff, inv)) << (8 * c);
+                }
+                row[x] = out;
+            }
+        }
+    };
+
+    class Framebuffer {
+        int width_, height_, tilesX_, tilesY_;
+        std::vector<std::uint32_t> pixels_;
+    public:
+        static constexpr int tileSize = Tile::tileSize;
+
+        Framebuffer(int width, int height)
+            : width_(width), height_(height),
+              tilesX_((width + tileSize - 1) / tileSize), tilesY_((height + tileSize - 1) / tileSize),
+              pixels_(static_cast<std::size_t>(tilesX_) * tilesY_ * tileSize * tileSize, 0) {}
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+        int tilesX() const { return tilesX_; }
+        int tilesY() const { return tilesY_; }
+        int tileCount() const { return tilesX_ * tilesY_; }
+
+        PixelRect tileRect(int tile) const {
+            const int x0 = tile % tilesX_ * tileSize, y0 = tile / tilesX_ * tileSize;
+            return {x0, y0, std::min(x0 + tileSize, width_), std::min(y0 + tileSize, height_)};
+        }
+
+        Tile tile(int index) {
+            return Tile(tileRect(index), pixels_.data() + static_cast<std::size_t>(index) * tileSize * tileSize);
+        }
+
+        Color32 pixel(int x, int y) const {
+            const int t = y / tileSize * tilesX_ + x / tileSize;
+            const std::uint32_t v = pixels_[static_cast<std::size_t>(t) * tileSize * tileSize +
+                                            (y % tileSize) * tileSize + x % tileSize];
+            return Color32(v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, v >> 24);
+        }
+
+        void clear(Color32 c) { std::fill(pixels_.begin(), pixels_.end(), c.packed()); }
+
+        // FNV-1a over the visible pixels in row-major order
+        std::uint64_t checksum() const {
+            std::uint64_t h = 1469598103934665603ull;
+            for (int y = 0; y < height_; ++y) {
+                for (int x = 0; x < width_; ++x) h = (h ^ pixel(x, y).packed()) * 1099511628211ull;
+            }
+            return h;
+        }
+    };
+
+    class Shape {
+    protected:
+        Color color_;
+    public:
+        Shape(const Color& c) : color_(c) {}
+        // Pixels draw() may touch
+        virtual PixelRect bounds() const = 0;
+        // Draws the part of the shape that falls inside tile
+        virtual void draw(Tile& tile) const = 0;
+        virtual ~Shape() = default;
+    };
+
+    class Rect final : public Shape {
+        PixelRect r_;
+    public:
+        Rect(const Color& c, const PixelRect& r) : Shape(c), r_(r) {}
+        PixelRect bounds() const override { return r_; }
+        void draw(Tile& tile) const override {
+            const PixelRect area = r_.intersect(tile.rect());
+            for (int y = area.y0; y < area.y1; ++y) tile.blendSpan(y, area.x0, area.x1, color_);
+        }
+    };
+
+    // Covers the pixels whose centres lie inside the circle
+    class Circle final : public Shape {
+        float cx_, cy_, r_;
+    public:
+        Circle(const Color& c, float cx, float cy, float r) : Shape(c), cx_(cx), cy_(cy), r_(r) {}
+        PixelRect bounds() const override {
+            return {static_cast<int>(std::floor(cx_ - r_)), static_cast<int>(std::floor(cy_ - r_)),
+                    static_cast<int>(std::ceil(cx_ + r_)) + 1, static_cast<int>(std::ceil(cy_ + r_)) + 1};
+        }
+        void draw(Tile& tile) const override {
+            const PixelRect area = bounds().intersect(tile.rect());
+            for (int y = area.y0; y < area.y1; ++y) {
+                const float dy = y + 0.5f - cy_;
+                const float h2 = r_ * r_ - dy * dy;
+                if (h2 < 0.0f) continue;
+                const float half = std::sqrt(h2);
+                tile.blendSpan(y, static_cast<int>(std::ceil(cx_ - half - 0.5f)),
+                               static_cast<int>(std::floor(cx_ + half - 0.5f)) + 1, color_);
+            }
+        }
+    };
+
+    namespace detail {
+        // Runs body(t) for t in [0, threads) and waits
+        template <typename Body>
+        void onThreads(unsigned threads, Body body) {
+            std::vector<std::thread> pool;
+            for (unsigned t = 1; t < threads; ++t) pool.emplace_back(body, t);
+            body(0u);
+            for (auto& th : pool) th.join();
+        }
+
+        // Tile columns [x0, x1) and rows [y0, y1) touched by b, clipped to the frame
+        PixelRect tileSpan(const Framebuffer& fb, PixelRect b) {
+            b = b.intersect({0, 0, fb.width(), fb.height()});
+            if (b.empty()) return {0, 0, 0, 0};
+            return {b.x0 / Framebuffer::tileSize, b.y0 / Framebuffer::tileSize,
+                    (b.x1 - 1) / Framebuffer::tileSize + 1, (b.y1 - 1) / Framebuffer::tileSize + 1};
+        }
+
+        // Per-worker ranges of work items; the owner pops from the front, thieves
+        // take from the back. Each range is one 64-bit word (begin | end << 32)
+        // updated by compare-and-swap.
+        class StealingRanges {
+            struct alignas(64) Range {
+                std::atomic<std::uint64_t> bounds{0};
+            };
+            std::vector<Range> ranges_;
+
+            static std::uint64_t pack(std::uint32_t begin, std::uint32_t end) {
+                return begin | static_cast<std::uint64_t>(end) << 32;
+            }
+
+        public:
+            StealingRanges(std::uint32_t items, unsigned workers) : ranges_(workers) {
+                for (unsigned w = 0; w < workers; ++w) {
+                    ranges_[w].bounds.store(pack(static_cast<std::uint32_t>(std::uint64_t(items) * w / workers),
+                                                 static_cast<std::uint32_t>(std::uint64_t(items) * (w + 1) / workers)),
+                                            std::memory_order_relaxed);
+                }
+            }
+
+            bool next(unsigned worker, std::uint32_t& item) {
+                std::atomic<std::uint64_t>& own = ranges_[worker].bounds;
+                for (std::uint64_t v = own.load(std::memory_order_relaxed);;) {
+                    const std::uint32_t begin = static_cast<std::uint32_t>(v), end = static_cast<std::uint32_t>(v >> 32);
+                    if (begin >= end) break;
+                    if (own.compare_exchange_weak(v, pack(begin + 1, end), std::memory_order_acq_rel)) {
+                        item = begin;
+                        return true;
+                    }
+                }
+                for (std::size_t k = 1; k < ranges_.size(); ++k) {
+                    std::atomic<std::uint64_t>& victim = ranges_[(worker + k) % ranges_.size()].bounds;
+                    for (std::uint64_t v = victim.load(std::memory_order_relaxed);;) {
+                        const std::uint32_t begin = static_cast<std::uint32_t>(v), end = static_cast<std::uint32_t>(v >> 32);
+                        if (begin >= end) break;
+                        if (victim.compare_exchange_weak(v, pack(begin, end - 1), std::memory_order_acq_rel)) {
+                            item = end - 1;
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+        };
+    }
+
+    // One shape straight onto the framebuffer, tile by tile
+    void render(const Shape& shape, Framebuffer& fb) {
+        const PixelRect span = detail::tileSpan(fb, shape.bounds());
+        for (int ty = span.y0; ty < span.y1; ++ty) {
+            for (int tx = span.x0; tx < span.x1; ++tx) {
+                Tile tile = fb.tile(ty * fb.tilesX() + tx);
+                shape.draw(tile);
+            }
+        }
+    }
+
+    // Bins shapes[0, n) to tiles and rasterizes the tiles in parallel
+    void render(const Shape* const* shapes, std::size_t n, Framebuffer& fb, unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t tiles = static_cast<std::size_t>(fb.tileCount());
+
+        // Bin: count per (thread, tile), prefix tile-major, then fill
+        std::vector<PixelRect> spans(n);
+        std::vector<std::uint32_t> counts(threads * tiles, 0);
+        detail::onThreads(threads, [&](unsigned t) {
+            std::uint32_t* count = counts.data() + t * tiles;
+            for (std::size_t i = n * t / threads, end = n * (t + 1) / threads; i < end; ++i) {
+                spans[i] = detail::tileSpan(fb, shapes[i]->bounds());
+                for (int ty = spans[i].y0; ty < spans[i].y1; ++ty) {
+                    for (int tx = spans[i].x0; tx < spans[i].x1; ++tx) ++count[ty * fb.tilesX() + tx];
+                }
+            }
+        });
+        std::vector<std::size_t> binStart(tiles + 1);
+        std::size_t running = 0;
+        for (std::size_t tile = 0; tile < tiles; ++tile) {
+            binStart[tile] = running;
+            for (unsigned t = 0; t < threads; ++t) {
+                const std::uint32_t c = counts[t * tiles + tile];
+                counts[t * tiles + tile] = static_cast<std::uint32_t>(running);   // becomes a write cursor
+                running += c;
+            }
+        }
+        binStart[tiles] = running;
+        std::vector<std::uint32_t> bins(running);
+        detail::onThreads(threads, [&](unsigned t) {
+            std::uint32_t* cursor = counts.data() + t * tiles;
+            for (std::size_t i = n * t / threads, end = n * (t + 1) / threads; i < end; ++i) {
+                for (int ty = spans[i].y0; ty < spans[i].y1; ++ty) {
+                    for (int tx = spans[i].x0; tx < spans[i].x1; ++tx) {
+                        bins[cursor[ty * fb.tilesX() + tx]++] = static_cast<std::uint32_t>(i);
+                    }
+                }
+            }
+        });
+
+        // Rasterize: one worker per tile at a time, stealing when idle
+        detail::StealingRanges work(static_cast<std::uint32_t>(tiles), threads);
+        detail::onThreads(threads, [&](unsigned w) {
+            for (std::uint32_t index; work.next(w, index);) {
+                Tile tile = fb.tile(static_cast<int>(index));
+                for (std::size_t k = binStart[index]; k < binStart[index + 1]; ++k) shapes[bins[k]]->draw(tile);
+            }
+        });
+    }
+
+    void render(const std::vector<std::unique_ptr<Shape>>& shapes, Framebuffer& fb, unsigned threads = 0) {
+        std::vector<const Shape*> raw;
+        raw.reserve(shapes.size());
+        for (const auto& s : shapes) raw.push_back(s.get());
+        render(raw.data(), raw.size(), fb, threads);
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int width = 3840, height = 2160;
+
+    // Half the shapes uniform, half clustered in the centre, so tiles differ in cost
+    std::mt19937 rng(58);
+    std::uniform_real_distribution<float> ux(0.0f, width), uy(0.0f, height), size(2.0f, 24.0f);
+    std::normal_distribution<float> cx(width / 2.0f, width / 10.0f), cy(height / 2.0f, height / 10.0f);
+    std::uniform_int_distribution<int> channel(0, 255), alpha(64, 255);
+    std::vector<std::unique_ptr<graphics::Shape>> scene;
+    scene.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const float x = (i % 2) ? ux(rng) : cx(rng), y = (i % 2) ? uy(rng) : cy(rng), s = size(rng);
+        const graphics::Color c(channel(rng), channel(rng), channel(rng), (i % 3) ? 255 : alpha(rng));
+        if (i % 2) {
+            scene.push_back(std::make_unique<graphics::Circle>(c, x, y, s / 2));
+        } else {
+            const int x0 = static_cast<int>(x), y0 = static_cast<int>(y);
+            scene.push_back(std::make_unique<graphics::Rect>(
+                c, graphics::PixelRect{x0, y0, x0 + static_cast<int>(s), y0 + static_cast<int>(s * 0.6f)}));
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    // Reference: every shape in turn, on one thread
+    graphics::Framebuffer reference(width, height);
+    reference.clear(graphics::Color(255, 255, 255));
+    auto t0 = Clock::now();
+    for (const auto& shape : scene) render(*shape, reference);  // ADL
+    auto t1 = Clock::now();
+    const std::uint64_t expected = reference.checksum();
+    std::cout << n << " shapes on " << width << "x" << height << " (" << reference.tileCount() << " tiles)\n";
+    std::cout << "  shape by shape:   " << ms(t1 - t0) << " ms\n";
+
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < hardware; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(hardware);
+    double single = 0.0;
+    for (unsigned threads : threadCounts) {
+        graphics::Framebuffer fb(width, height);
+        fb.clear(graphics::Color(255, 255, 255));
+        auto t2 = Clock::now();
+        render(scene, fb, threads);
+        auto t3 = Clock::now();
+        if (threads == 1) single = ms(t3 - t2);
+        std::cout << "  tiled, " << threads << " thread(s): " << ms(t3 - t2) << " ms (speedup "
+                  << single / ms(t3 - t2) << ", identical: " << (fb.checksum() == expected ? "yes" : "no")
+                  << ")\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,312 @@
+// Good: Arena allocation for polymorphic graphics shapes, inside the graphics namespace
+// A scene built from std::make_unique<Circle>(...) costs one malloc and one
+// free per shape, and the shapes end up scattered across the heap.
+//
+// ShapeArena constructs shapes of any concrete type back to back in large
+// blocks by bumping a pointer, and destroys them all at once: reset() or the
+// arena's destructor runs the destructors in reverse creation order and keeps
+// or frees whole blocks. Types whose destructors do nothing observable can opt
+// in to skipping them by specialising arena_skip_destructor; a scene of such
+// shapes is torn down in O(blocks) instead of O(shapes).
+//
+// Shapes in an arena are ordinary Shape objects, so render(const Shape&) and
+// anything else taking a Shape& works with them unchanged. They must not be
+// deleted or outlive the arena.
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graphics {
+    class Color {
+        int r_, g_, b_;
+    public:
+        Color(int r, int g, int b) : r_(r), g_(g), b_(b) {}
+        int red() const { return r_; }
+        int green() const { return g_; }
+        int blue() const { return b_; }
+    };
+
+    // Stand-in output target: accumulates covered area and a colour checksum
+    struct Canvas {
+        double area = 0.0;
+        double ink = 0.0;
+
+        void fill(double a, const Color& c) {
+            area += a;
+            ink += a * (c.red() + 2 * c.green() + 3 * c.blue());
+        }
+    };
+
+    Canvas& canvas() {
+        static Canvas c;
+        return c;
+    }
+
+    class Shape {
+    protected:
+        Color color_;
+    public:
+        Shape(const Color& c) : color_(c) {}
+        virtual void draw() const = 0;
+        virtual ~Shape() = default;
+    };
+
+    class Circle final : public Shape {
+        float x_, y_, r_;
+    public:
+        Circle(const Color& c, float x, float y, float r) : Shape(c), x_(x), y_(y), r_(r) {}
+        void draw() const override { canvas().fill(3.14159265 * r_ * r_, color_); }
+    };
+
+    class Rect final : public Shape {
+        float x_, y_, w_, h_;
+    public:
+        Rect(const Color& c, float x, float y, float w, float h) : Shape(c), x_(x), y_(y), w_(w), h_(h) {}
+        void draw() const override { canvas().fill(static_cast<double>(w_) * h_, color_); }
+    };
+
+    class Triangle final : public Shape {
+        float x0_, y0_, x1_, y1_, x2_, y2_;
+    public:
+        Triangle(const Color& c, float x0, float y0, float x1, float y1, float x2, float y2)
+            : Shape(c), x0_(x0), y0_(y0), x1_(x1), y1_(y1), x2_(x2), y2_(y2) {}
+        void draw() const override {
+            const double cross = (static_cast<double>(x1_) - x0_) * (y2_ - y0_) -
+                                 (static_cast<double>(x2_) - x0_) * (y1_ - y0_);
+            canvas().fill(0.5 * (cross < 0 ? -cross : cross), color_);
+        }
+    };
+
+    // Owns a string, so its destructor must run
+    class Label final : public Shape {
+        std::string text_;
+    public:
+        Label(const Color& c, std::string text) : Shape(c), text_(std::move(text)) {}
+        void draw() const override { canvas().fill(static_cast<double>(text_.size()), color_); }
+    };
+
+    // Function that works with graphics types
+    void render(const Shape& shape) {
+        shape.draw();
+    }
+
+    // Specialise to true for shapes whose destructor has no effect (every member
+    // trivially destructible) to let ShapeArena skip calling it
+    template <typename T>
+    struct arena_skip_destructor : std::false_type {};
+
+    template <> struct arena_skip_destructor<Circle> : std::true_type {};
+    template <> struct arena_skip_destructor<Rect> : std::true_type {};
+    template <> struct arena_skip_destructor<Triangle> : std::true_type {};
+
+    class ShapeArena {
+        struct Block {
+            std::unique_ptr<unsigned char[]> data;
+            std::size_t size;
+        };
+
+        std::size_t blockSize_;
+        std::vector<Block> blocks_;
+        std::size_t current_ = 0;      // block being filled
+        std::size_t used_ = 0;         // bytes used in blocks_[current_]
+        std::vector<Shape*> shapes_;   // creation order
+        std::vector<Shape*> owned_;    // the subset whose destructors must run
+
+        void* allocate(std::size_t size, std::size_t align) {
+            for (; current_ < blocks_.size(); ++current_, used_ = 0) {
+                const std::size_t offset = (used_ + align - 1) & ~(align - 1);
+                if (offset + size <= blocks_[current_].size) {
+                    used_ = offset + size;
+                    return blocks_[current_].data.get() + offset;
+                }
+            }
+            // Oversized shapes get a block of their own
+            const std::size_t bytes = std::max(blockSize_, size);
+            blocks_.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[bytes]), bytes});
+            current_ = blocks_.size() - 1;
+            used_ = size;
+            return blocks_[current_].data.get();
+        }
+
+        void destroyAll() {
+            for (auto it = owned_.rbegin(); it != owned_.rend(); ++it) (*it)->~Shape();
+            owned_.clear();
+            shapes_.clear();
+        }
+
+    public:
+        explicit ShapeArena(std::size_t blockSize = 256 * 1024) : blockSize_(blockSize) {}
+        ~ShapeArena() { destroyAll(); }
+
+        ShapeArena(const ShapeArena&) = delete;
+        ShapeArena& operator=(const ShapeArena&) = delete;
+
+        // Constructs a T in the arena; the arena owns it from here on
+        template <typename T, typename... Args>
+        T& create(Args&&... args) {
+            static_assert(std::is_base_of<Shape, T>::value, "ShapeArena holds graphics::Shape types");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned shapes are not supported");
+            if (shapes_.size() == shapes_.capacity()) shapes_.reserve(2 * shapes_.size() + 16);
+            if (!arena_skip_destructor<T>::value && owned_.size() == owned_.capacity()) {
+                owned_.reserve(2 * owned_.size() + 16);
+            }
+            T* shape = ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            shapes_.push_back(shape);   // cannot throw: capacity reserved above
+            if (!arena_skip_destructor<T>::value) owned_.push_back(shape);
+            return *shape;
+        }
+
+        // Room for n more shapes in the bookkeeping vectors
+        void reserve(std::size_t n) {
+            shapes_.reserve(shapes_.size() + n);
+            owned_.reserve(owned_.size() + n);
+        }
+
+        // Destroys every shape and keeps the blocks for reuse
+        void reset() {
+            destroyAll();
+            current_ = 0;
+            used_ = 0;
+        }
+
+        std::size_t size() const { return shapes_.size(); }
+        std::size_t bytesReserved() const {
+            std::size_t n = 0;
+            for (const Block& b : blocks_) n += b.size;
+            return n;
+        }
+        const std::vector<Shape*>& shapes() const { return shapes_; }
+    };
+
+    // Every shape in creation order
+    void render(const ShapeArena& arena) {
+        for (const Shape* shape : arena.shapes()) render(*shape);
+    }
+
+    template <typename Fn>
+    void for_each_shape(const ShapeArena& arena, Fn fn) {
+        for (const Shape* shape : arena.shapes()) fn(*shape);
+    }
+}
+
+namespace {
+    template <typename T>
+    struct Kind { using type = T; };
+
+    // The same pseudo-random scene, handed to make(Kind<T>(), args...) shape by shape
+    struct SceneSpec {
+        std::vector<float> values;
+        std::vector<std::uint8_t> kinds;
+
+        SceneSpec(std::size_t n, unsigned seed) : values(8 * n), kinds(n) {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> v(1.0f, 255.0f);
+            std::uniform_int_distribution<int> kind(0, 2);
+            for (float& x : values) x = v(rng);
+            for (std::uint8_t& k : kinds) k = static_cast<std::uint8_t>(kind(rng));
+        }
+
+        template <typename Make>
+        void build(Make make) const {
+            for (std::size_t i = 0; i < kinds.size(); ++i) {
+                const float* p = values.data() + 8 * i;
+                const graphics::Color c(static_cast<int>(p[0]), static_cast<int>(p[1]), static_cast<int>(p[2]));
+                switch (kinds[i]) {
+                case 0: make(Kind<graphics::Circle>(), c, p[3], p[4], p[5] / 32); break;
+                case 1: make(Kind<graphics::Rect>(), c, p[3], p[4], p[5] / 32, p[6] / 32); break;
+                default: make(Kind<graphics::Triangle>(), c, p[3], p[4], p[3] + p[5] / 32, p[4], p[3], p[4] + p[6] / 32); break;
+                }
+            }
+        }
+    };
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const SceneSpec spec(n, 58);
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    // Walking the scene description alone, to subtract from the build times
+    double checksum = 0.0;
+    auto s0 = Clock::now();
+    spec.build([&](auto, const graphics::Color& c, float x, float y, auto... rest) {
+        checksum += c.red() + x + y + sizeof...(rest);
+    });
+    auto s1 = Clock::now();
+
+    // One heap allocation per shape
+    graphics::canvas() = graphics::Canvas();
+    auto t0 = Clock::now();
+    auto* heapScene = new std::vector<std::unique_ptr<graphics::Shape>>();
+    heapScene->reserve(n);
+    spec.build([&](auto kind, const auto&... args) {
+        heapScene->push_back(std::make_unique<typename decltype(kind)::type>(args...));
+    });
+    auto t1 = Clock::now();
+    for (const auto& shape : *heapScene) render(*shape);  // ADL
+    auto t2 = Clock::now();
+    delete heapScene;
+    auto t3 = Clock::now();
+    const graphics::Canvas heapResult = graphics::canvas();
+
+    // The same shapes in a fresh arena
+    graphics::canvas() = graphics::Canvas();
+    auto inArena = [](graphics::ShapeArena& a) {
+        return [&a](auto kind, const auto&... args) { a.create<typename decltype(kind)::type>(args...); };
+    };
+    auto t4 = Clock::now();
+    auto* arena = new graphics::ShapeArena();
+    arena->reserve(n);
+    spec.build(inArena(*arena));
+    auto t5 = Clock::now();
+    render(*arena);
+    auto t6 = Clock::now();
+    const std::size_t arenaBytes = arena->bytesReserved();
+    delete arena;
+    auto t7 = Clock::now();
+    const graphics::Canvas arenaResult = graphics::canvas();
+
+    // Rebuilding each frame into a reset arena reuses its blocks
+    graphics::ShapeArena frameArena;
+    spec.build(inArena(frameArena));
+    auto t8 = Clock::now();
+    frameArena.reset();
+    auto t9 = Clock::now();
+    spec.build(inArena(frameArena));
+    auto t10 = Clock::now();
+
+    // Shapes with real destructors still get them, in reverse creation order
+    frameArena.reset();
+    for (std::size_t i = 0; i < n / 10; ++i) {
+        frameArena.create<graphics::Label>(graphics::Color(0, 0, 0), "label #" + std::to_string(i) + " with heap-allocated text");
+    }
+    auto t11 = Clock::now();
+    frameArena.reset();
+    auto t12 = Clock::now();
+
+    std::cout << n << " shapes (walking the scene description alone: " << ms(s1 - s0) << " ms, checksum "
+              << checksum << ")\n";
+    std::cout << "  make_unique:  build " << ms(t1 - t0) << " ms, render " << ms(t2 - t1) << " ms, teardown "
+              << ms(t3 - t2) << " ms (area " << heapResult.area << ")\n";
+    std::cout << "  ShapeArena:   build " << ms(t5 - t4) << " ms, render " << ms(t6 - t5) << " ms, teardown "
+              << ms(t7 - t6) << " ms (area " << arenaResult.area << ", " << arenaBytes / 1024 << " KiB in blocks)\n";
+    std::cout << "  reused arena: reset " << ms(t9 - t8) << " ms, rebuild " << ms(t10 - t9) << " ms\n";
+    std::cout << "  " << n / 10 << " Labels with destructors: reset " << ms(t12 - t11) << " ms\n";
+    std::cout << "  same result: " << (heapResult.area == arenaResult.area && heapResult.ink == arenaResult.ink ? "yes" : "no")
+              << "\n";
+
+    return 0;
+}
@@ -0,0 +1,448 @@
+// Good: A spatial index in the geometry namespace, used by (not mixed into) graphics
+// The R-tree knows only boxes and integer ids, so it lives with the other
+// geometry types and has no idea what a Shape is. graphics depends on geometry,
+// never the other way round: Shapes report a geometry::Box and a Scene keeps an
+// RTree over those boxes, so render() can cull and hit-testing can skip
+// everything away from the cursor instead of walking every Shape.
+//
+// RTree is packed: built once from all boxes, never updated. Sort-Tile-Recursive
+// (STR) loading cuts the boxes into vertical slices by centre x, sorts each
+// slice by centre y and packs runs of nodeSize into leaves; upper levels group
+// consecutive nodes. All levels sit in one flat array, so a node's children are
+// found by arithmetic rather than pointers. The bulk loader splits slices with
+// nth_element on parallel tasks and sorts slices on a thread pool.
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Geometry types and the index over them
+namespace geometry {
+    // Axis-aligned box; an empty box has min > max
+    struct Box {
+        double minX, minY, maxX, maxY;
+
+        static Box empty() {
+            const double inf = std::numeric_limits<double>::infinity();
+            return {inf, inf, -inf, -inf};
+        }
+
+        bool intersects(const Box& o) const {
+            return minX <= o.maxX && o.minX <= maxX && minY <= o.maxY && o.minY <= maxY;
+        }
+        bool contains(double x, double y) const {
+            return minX <= x && x <= maxX && minY <= y && y <= maxY;
+        }
+        void expand(const Box& o) {
+            minX = std::min(minX, o.minX); minY = std::min(minY, o.minY);
+            maxX = std::max(maxX, o.maxX); maxY = std::max(maxY, o.maxY);
+        }
+        // Squared distance from (x, y) to the box, 0 inside
+        double distance2(double x, double y) const {
+            const double dx = std::max(std::max(minX - x, 0.0), x - maxX);
+            const double dy = std::max(std::max(minY - y, 0.0), y - maxY);
+            return dx * dx + dy * dy;
+        }
+    };
+
+    class RTree {
+    public:
+        using Id = std::uint32_t;
+        static constexpr std::size_t nodeSize = 16;
+        static constexpr Id noId = std::numeric_limits<Id>::max();
+
+        struct Hit {
+            Id id;
+            double distance;
+        };
+
+        RTree() = default;
+
+        // Indexes boxes[0, n); ids are positions in that array
+        RTree(const Box* boxes, std::size_t n, unsigned threads = 0) {
+            if (n >= noId) {
+                throw std::length_error("RTree: more than 2^32 - 1 boxes");
+            }
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            if (n < (1u << 14)) threads = 1;
+            load(boxes, n, threads);
+        }
+
+        explicit RTree(const std::vector<Box>& boxes, unsigned threads = 0)
+            : RTree(boxes.data(), boxes.size(), threads) {}
+
+        std::size_t size() const { return ids_.size(); }
+        bool empty() const { return ids_.empty(); }
+        Box bounds() const { return boxes_.empty() ? Box::empty() : boxes_.back(); }
+
+        // fn(id) for every box intersecting window, in no particular order
+        template <typename Fn>
+        friend void for_each_intersecting(const RTree& tree, const Box& window, Fn fn) {
+            // With a single entry the root is that entry, so it is tested like any other
+            if (tree.empty() || !tree.boxes_.back().intersects(window)) return;
+            std::vector<std::pair<std::size_t, std::size_t>> stack;   // (position, level)
+            stack.emplace_back(tree.boxes_.size() - 1, tree.levels_.size() - 2);
+            while (!stack.empty()) {
+                const std::size_t pos = stack.back().first, level = stack.back().second;
+                stack.pop_back();
+                if (level == 0) {
+                    fn(tree.ids_[pos]);
+                    continue;
+                }
+                const std::pair<std::size_t, std::size_t> range = tree.children(pos, level);
+                for (std::size_t c = range.first; c < range.second; ++c) {
+                    if (tree.boxes_[c].intersects(window)) stack.emplace_back(c, level - 1);
+                }
+            }
+        }
+
+        friend Hit nearest(const RTree& tree, double x, double y);
+
+    private:
+        std::vector<Box> boxes_;               // leaf entries, then each node level up to the root
+        std::vector<Id> ids_;                  // input index of each leaf entry
+        std::vector<std::size_t> levels_;      // start of each level in boxes_, plus the end
+
+        // Entries of level - 1 under the node at pos on level
+        std::pair<std::size_t, std::size_t> children(std::size_t pos, std::size_t level) const {
+            const std::size_t first = levels_[level - 1] + (pos - levels_[level]) * nodeSize;
+            return {first, std::min(first + nodeSize, levels_[level])};
+        }
+
+        void load(const Box* boxes, std::size_t n, unsigned threads);
+    };
+
+    namespace detail {
+        // Runs body(t) for t in [0, threads) and waits
+        template <typename Body>
+        void onThreads(unsigned threads, Body body) {
+            std::vector<std::thread> pool;
+            for (unsigned t = 1; t < threads; ++t) pool.emplace_back(body, t);
+            body(0u);
+            for (auto& th : pool) th.join();
+        }
+
+        // Reorders ids[begin, end) so that every slice of sliceSize (counted
+        // from base) holds the ids whose key ranks in that slice
+        template <typename Key>
+        void partitionSlices(RTree::Id* ids, std::size_t begin, std::size_t end, std::size_t base,
+                             std::size_t sliceSize, const Key& key, int spawnDepth) {
+            const std::size_t firstCut = (begin - base) / sliceSize + 1;
+            const std::size_t lastCut = (end - base - 1) / sliceSize;
+            if (firstCut > lastCut) return;
+            const std::size_t mid = base + (firstCut + lastCut) / 2 * sliceSize;
+            std::nth_element(ids + begin, ids + mid, ids + end,
+                             [&](RTree::Id a, RTree::Id b) { return key[a] < key[b]; });
+            if (spawnDepth > 0) {
+                auto left = std::async(std::launch::async, [=, &key] {
+                    partitionSlices(ids, begin, mid, base, sliceSize, key, spawnDepth - 1);
+                });
+                partitionSlices(ids, mid, end, base, sliceSize, key, spawnDepth - 1);
+                left.get();
+            } else {
+                partitionSlices(ids, begin, mid, base, sliceSize, key, 0);
+                partitionSlices(ids, mid, end, base, sliceSize, key, 0);
+            }
+        }
+    }
+
+    void RTree::load(const Box* boxes, std::size_t n, unsigned threads) {
+        boxes_.clear();
+        ids_.clear();
+        levels_.clear();
+        if (n == 0) return;
+
+        std::vector<double> cx(n), cy(n);
+        ids_.resize(n);
+        detail::onThreads(threads, [&](unsigned t) {
+            for (std::size_t i = n * t / threads, end = n * (t + 1) / threads; i < end; ++i) {
+                cx[i] = boxes[i].minX + boxes[i].maxX;
+                cy[i] = boxes[i].minY + boxes[i].maxY;
+                ids_[i] = static_cast<Id>(i);
+            }
+        });
+
+        // Sort-Tile-Recursive: S vertical slices of S leaves each
+        const std::size_t leaves = (n + nodeSize - 1) / nodeSize;
+        const std::size_t slices = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(leaves))));
+        const std::size_t sliceSize = ((leaves + slices - 1) / slices) * nodeSize;
+        int spawnDepth = 0;
+        while ((1u << spawnDepth) < threads) ++spawnDepth;
+        detail::partitionSlices(ids_.data(), 0, n, 0, sliceSize, cx, spawnDepth);
+
+        std::atomic<std::size_t> nextSlice{0};
+        detail::onThreads(threads, [&](unsigned) {
+            for (std::size_t s; (s = nextSlice.fetch_add(1)) * sliceSize < n;) {
+                Id* first = ids_.data() + s * sliceSize;
+                Id* last = ids_.data() + std::min(n, (s + 1) * sliceSize);
+                std::sort(first, last, [&](Id a, Id b) { return cy[a] < cy[b]; });
+            }
+        });
+
+        // Level sizes first, so the flat array is allocated once
+        levels_.push_back(0);
+        for (std::size_t count = n;;) {
+            levels_.push_back(levels_.back() + count);
+            if (count == 1) break;
+            count = (count + nodeSize - 1) / nodeSize;
+        }
+        boxes_.resize(levels_.back());
+
+        detail::onThreads(threads, [&](unsigned t) {
+            for (std::size_t i = n * t / threads, end = n * (t + 1) / threads; i < end; ++i) {
+                boxes_[i] = boxes[ids_[i]];
+            }
+        });
+        for (std::size_t level = 1; level + 1 < levels_.size(); ++level) {
+            const std::size_t begin = levels_[level], count = levels_[level + 1] - begin;
+            const unsigned levelThreads = count >= 4096 ? threads : 1;
+            detail::onThreads(levelThreads, [&](unsigned t) {
+                for (std::size_t i = count * t / levelThreads, end = count * (t + 1) / levelThreads;
+                     i < end; ++i) {
+                    Box b = Box::empty();
+                    const std::pair<std::size_t, std::size_t> range = children(begin + i, level);
+                    for (std::size_t c = range.first; c < range.second; ++c) b.expand(boxes_[c]);
+                    boxes_[begin + i] = b;
+                }
+            });
+        }
+    }
+
+    // Ids of all boxes intersecting window
+    std::vector<RTree::Id> search(const RTree& tree, const Box& window) {
+        std::vector<RTree::Id> result;
+        for_each_intersecting(tree, window, [&](RTree::Id id) { result.push_back(id); });
+        return result;
+    }
+
+    // Ids of all boxes containing (x, y)
+    std::vector<RTree::Id> search(const RTree& tree, double x, double y) {
+        return search(tree, Box{x, y, x, y});
+    }
+
+    // Box closest to (x, y), best-first; distance 0 if (x, y) is inside it.
+    // An empty tree gives id noId and an infinite distance.
+    RTree::Hit nearest(const RTree& tree, double x, double y) {
+        if (tree.empty()) {
+            return {RTree::noId, std::numeric_limits<double>::infinity()};
+        }
+        struct Entry {
+            double d2;
+            std::size_t pos, level;
+            bool operator<(const Entry& o) const { return d2 > o.d2; }   // min-heap
+        };
+        std::priority_queue<Entry> queue;
+        queue.push({tree.boxes_.back().distance2(x, y), tree.boxes_.size() - 1, tree.levels_.size() - 2});
+        while (!queue.empty()) {
+            const Entry e = queue.top();
+            queue.pop();
+            if (e.level == 0) {
+                return {tree.ids_[e.pos], std::sqrt(e.d2)};
+            }
+            const std::pair<std::size_t, std::size_t> range = tree.children(e.pos, e.level);
+            for (std::size_t c = range.first; c < range.second; ++c) {
+                queue.push({tree.boxes_[c].distance2(x, y), c, e.level - 1});
+            }
+        }
+        return {RTree::noId, std::numeric_limits<double>::infinity()};
+    }
+}
+
+// Graphics types: depend on geometry for bounds, add colour and drawing
+namespace graphics {
+    class Color {
+        int r_, g_, b_;
+    public:
+        Color(int r, int g, int b) : r_(r), g_(g), b_(b) {}
+        int red() const { return r_; }
+        int green() const { return g_; }
+        int blue() const { return b_; }
+    };
+
+    class Shape {
+    protected:
+        Color color_;
+    public:
+        Shape(const Color& c) : color_(c) {}
+        virtual void draw() const = 0;
+        // Everything draw() can touch lies inside bounds()
+        virtual geometry::Box bounds() const = 0;
+        // Exact hit test; bounds() is the conservative one
+        virtual bool contains(double x, double y) const { return bounds().contains(x, y); }
+        virtual ~Shape() = default;
+    };
+
+    // Counts draw() calls so the demo can show what culling saved
+    std::size_t drawCalls = 0;
+
+    class Rect : public Shape {
+        geometry::Box box_;
+    public:
+        Rect(const Color& c, const geometry::Box& box) : Shape(c), box_(box) {}
+        void draw() const override { ++drawCalls; }
+        geometry::Box bounds() const override { return box_; }
+    };
+
+    class Circle : public Shape {
+        double x_, y_, r_;
+    public:
+        Circle(const Color& c, double x, double y, double r) : Shape(c), x_(x), y_(y), r_(r) {}
+        void draw() const override { ++drawCalls; }
+        geometry::Box bounds() const override { return {x_ - r_, y_ - r_, x_ + r_, y_ + r_}; }
+        bool contains(double x, double y) const override {
+            return (x - x_) * (x - x_) + (y - y_) * (y - y_) <= r_ * r_;
+        }
+    };
+
+    // Function that works with graphics types
+    void render(const Shape& shape) {
+        shape.draw();
+    }
+
+    // Shapes in paint order, with an index over their bounds. Call build()
+    // after the last add() and before rendering or hit-testing.
+    class Scene {
+        std::vector<std::unique_ptr<Shape>> shapes_;
+        geometry::RTree index_;
+    public:
+        void add(std::unique_ptr<Shape> shape) { shapes_.push_back(std::move(shape)); }
+
+        void build(unsigned threads = 0) {
+            std::vector<geometry::Box> boxes;
+            boxes.reserve(shapes_.size());
+            for (const auto& s : shapes_) boxes.push_back(s->bounds());
+            index_ = geometry::RTree(boxes, threads);
+        }
+
+        const std::vector<std::unique_ptr<Shape>>& shapes() const { return shapes_; }
+        const geometry::RTree& index() const { return index_; }
+    };
+
+    // Draws only the shapes whose bounds meet the viewport, in paint order
+    void render(const Scene& scene, const geometry::Box& viewport) {
+        std::vector<geometry::RTree::Id> visible = search(scene.index(), viewport);
+        std::sort(visible.begin(), visible.end());
+        for (geometry::RTree::Id id : visible) render(*scene.shapes()[id]);
+    }
+
+    // Topmost shape under (x, y), or nullptr
+    const Shape* hit_test(const Scene& scene, double x, double y) {
+        const Shape* top = nullptr;
+        geometry::RTree::Id topId = 0;
+        for_each_intersecting(scene.index(), geometry::Box{x, y, x, y}, [&](geometry::RTree::Id id) {
+            if ((!top || id > topId) && scene.shapes()[id]->contains(x, y)) {
+                top = scene.shapes()[id].get();
+                topId = id;
+            }
+        });
+        return top;
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const double world = 100000.0;
+
+    std::mt19937 rng(58);
+    std::uniform_real_distribution<double> coord(0.0, world), size(2.0, 60.0);
+    graphics::Scene scene;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double x = coord(rng), y = coord(rng);
+        if (i % 2) {
+            scene.add(std::make_unique<graphics::Rect>(graphics::Color(255, 0, 0),
+                                                       geometry::Box{x, y, x + size(rng), y + size(rng)}));
+        } else {
+            scene.add(std::make_unique<graphics::Circle>(graphics::Color(0, 0, 255), x, y, size(rng) / 2));
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    std::vector<geometry::Box> boxes;
+    for (const auto& s : scene.shapes()) boxes.push_back(s->bounds());
+    auto t0 = Clock::now();
+    geometry::RTree serial(boxes, 1);
+    auto t1 = Clock::now();
+    geometry::RTree parallel(boxes);
+    auto t2 = Clock::now();
+    scene.build();
+    std::cout << n << " shapes; STR bulk load " << ms(t1 - t0) << " ms on 1 thread, " << ms(t2 - t1)
+              << " ms on " << std::max(1u, std::thread::hardware_concurrency()) << "\n";
+
+    // Culling: every shape vs only the indexed candidates
+    const geometry::Box viewport{40000, 40000, 42560, 41440};
+    graphics::drawCalls = 0;
+    auto t3 = Clock::now();
+    for (const auto& s : scene.shapes()) {
+        if (s->bounds().intersects(viewport)) render(*s);
+    }
+    auto t4 = Clock::now();
+    const std::size_t linearDraws = graphics::drawCalls;
+    graphics::drawCalls = 0;
+    render(scene, viewport);
+    auto t5 = Clock::now();
+    std::cout << "Viewport cull: linear " << ms(t4 - t3) << " ms, indexed " << ms(t5 - t4) << " ms ("
+              << linearDraws << " vs " << graphics::drawCalls << " shapes drawn)\n";
+
+    // Hit-testing: linear topmost search vs the index. Clicks land near shape
+    // origins so that most of them hit something.
+    std::vector<std::pair<double, double>> clicks(100);
+    std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+    for (auto& c : clicks) {
+        const geometry::Box b = boxes[pick(rng)];
+        c = {b.minX + 3.0, b.minY + 3.0};
+    }
+    std::size_t mismatches = 0, hits = 0;
+    auto t6 = Clock::now();
+    std::vector<const graphics::Shape*> linearHits;
+    for (const auto& c : clicks) {
+        const graphics::Shape* top = nullptr;
+        for (const auto& s : scene.shapes()) {
+            if (s->contains(c.first, c.second)) top = s.get();
+        }
+        linearHits.push_back(top);
+    }
+    auto t7 = Clock::now();
+    for (std::size_t i = 0; i < clicks.size(); ++i) {
+        const graphics::Shape* top = hit_test(scene, clicks[i].first, clicks[i].second);
+        if (top) ++hits;
+        if (top != linearHits[i]) ++mismatches;
+    }
+    auto t8 = Clock::now();
+    std::cout << clicks.size() << " hit tests: linear " << ms(t7 - t6) << " ms, indexed " << ms(t8 - t7)
+              << " ms (" << hits << " hits, " << mismatches << " mismatches)\n";
+
+    // Nearest against brute force
+    std::size_t nearestMismatches = 0;
+    for (std::size_t i = 0; i < 100; ++i) {
+        const double x = coord(rng), y = coord(rng);
+        double best = std::numeric_limits<double>::infinity();
+        for (const auto& b : boxes) best = std::min(best, b.distance2(x, y));
+        if (nearest(scene.index(), x, y).distance != std::sqrt(best)) ++nearestMismatches;
+    }
+    std::cout << "nearest vs brute force: " << nearestMismatches << " mismatches in 100 queries\n";
+
+    // One entry: the root is the leaf itself
+    const geometry::RTree single(std::vector<geometry::Box>{geometry::Box{100, 100, 110, 110}});
+    const std::size_t singleHits = search(single, geometry::Box{0, 0, 10, 10}).size();
+    const double singleDistance = nearest(single, 0.0, 0.0).distance;
+    std::cout << "one-box tree: " << singleHits << " window hits (expected 0), nearest distance "
+              << singleDistance << " (expected " << std::sqrt(2.0) * 100 << ")\n";
+
+    return 0;
+}
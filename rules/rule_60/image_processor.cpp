@@ -0,0 +1,1004 @@
+// Good: A CPU image-processing engine behind dll_interface::IImageProcessor
+// The module boundary is image_processor.h: the client passes ImageDesc
+// descriptors (fixed-width fields plus plane pointers) for images it owns, and
+// gets the processor from createProcessor() and gives it back with release().
+// Everything the engine allocates - scratch images, per-thread row buffers and
+// its worker threads - is created and destroyed inside this module.
+//
+// process() runs grayscale -> separable Gaussian blur -> Sobel gradient
+// magnitude -> threshold. The stages after grayscale are Filters in a
+// Pipeline; each filter declares how many rows above and below it reads and
+// produces one output row at a time with a row kernel (AVX2, 16 pixels per
+// step, with a scalar fallback selected at runtime). All arithmetic is
+// integer: the blur weights are fixed point and sum to 256, so the AVX2 and
+// scalar kernels give identical images.
+//
+// The pipeline runs fused: workers of a pool that lives as long as the
+// processor take strips of output rows, and each stage keeps just the rows the
+// next stage reads in a rolling line buffer, producing them on demand. No
+// intermediate image is ever stored, so a frame is read once and written once.
+// The unfused flag instead runs every stage over the whole frame in turn.
+//
+// createAnalyzer() returns the sibling IImageAnalyzer for measurements that
+// other code builds on: summed-area tables (AVX2 row prefix sums, built in two
+// passes over bands of rows so every worker can start at once) for O(1) box
+// sums, and 256-bin histograms counted into per-worker sub-histograms and
+// summed at the end, with no atomics.
+
+#include "image_processor.h"
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define IMAGE_HAS_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define IMAGE_HAS_X86_SIMD 0
+#endif
+
+namespace dll_interface {
+    namespace detail {
+        constexpr int maxBlurRadius = 15;
+
+        // Symmetric weights w[0] (centre) .. w[radius], summing to 256 over all taps
+        struct BlurKernel {
+            int radius;
+            std::uint16_t w[maxBlurRadius + 1];
+        };
+
+        BlurKernel makeBlurKernel(float sigma) {
+            BlurKernel k{};
+            if (!(sigma > 0.0f)) {
+                k.w[0] = 256;
+                return k;
+            }
+            const int radius = std::min(maxBlurRadius, static_cast<int>(std::ceil(3.0f * sigma)));
+            double g[maxBlurRadius + 1], total = 0.0;
+            for (int i = 0; i <= radius; ++i) {
+                g[i] = std::exp(-0.5 * i * i / (static_cast<double>(sigma) * sigma));
+                total += (i == 0) ? g[i] : 2.0 * g[i];
+            }
+            int sum = 0;
+            for (int i = 1; i <= radius; ++i) {
+                k.w[i] = static_cast<std::uint16_t>(std::lround(256.0 * g[i] / total));
+                sum += 2 * k.w[i];
+                if (k.w[i] != 0) k.radius = i;
+            }
+            k.w[0] = static_cast<std::uint16_t>(256 - sum);   // absorbs the rounding
+            return k;
+        }
+
+        // Row kernels. n is the row length in pixels.
+        //   gray:      Y = (77 R + 150 G + 29 B + 128) >> 8
+        //   blurH:     in is padded: in[-radius] .. in[n - 1 + radius] are readable
+        //   blurV:     rows[0 .. 2 radius], the output row's source is rows[radius]
+        //   sobel:     |gx| + |gy| saturated to 255; columns are clamped at the ends
+        //   threshold: 255 where in >= t, else 0
+        //   integral:  out[x] = above[x] + in[0] + .. + in[x], modulo 2^32
+        //   addRow:    row[x] += offset[x], modulo 2^32
+        using GrayKernel = void (*)(const std::uint8_t*, const std::uint8_t*, const std::uint8_t*, std::uint8_t*, std::size_t);
+        using BlurHKernel = void (*)(const std::uint8_t*, const BlurKernel&, std::uint8_t*, std::size_t);
+        using BlurVKernel = void (*)(const std::uint8_t* const*, const BlurKernel&, std::uint8_t*, std::size_t);
+        using SobelKernel = void (*)(const std::uint8_t*, const std::uint8_t*, const std::uint8_t*, std::uint8_t*, std::size_t);
+        using ThresholdKernel = void (*)(const std::uint8_t*, std::uint8_t, std::uint8_t*, std::size_t);
+        using IntegralKernel = void (*)(const std::uint8_t*, const std::uint32_t*, std::uint32_t*, std::size_t);
+        using AddRowKernel = void (*)(const std::uint32_t*, std::uint32_t*, std::size_t);
+
+        inline std::uint8_t grayPixel(std::uint32_t r, std::uint32_t g, std::uint32_t b) {
+            return static_cast<std::uint8_t>((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+
+        inline std::uint8_t sobelPixel(const std::uint8_t* a, const std::uint8_t* r, const std::uint8_t* b,
+                                       std::size_t l, std::size_t x, std::size_t h) {
+            const int gx = (a[h] - a[l]) + 2 * (r[h] - r[l]) + (b[h] - b[l]);
+            const int gy = (b[l] + 2 * b[x] + b[h]) - (a[l] + 2 * a[x] + a[h]);
+            return static_cast<std::uint8_t>(std::min(255, std::abs(gx) + std::abs(gy)));
+        }
+
+        // Edge columns of a Sobel row, and every column when the row is too short for SIMD
+        inline void sobelColumns(const std::uint8_t* a, const std::uint8_t* r, const std::uint8_t* b,
+                                 std::uint8_t* out, std::size_t n, std::size_t x0, std::size_t x1) {
+            for (std::size_t x = x0; x < x1; ++x) {
+                out[x] = sobelPixel(a, r, b, x == 0 ? 0 : x - 1, x, x + 1 == n ? x : x + 1);
+            }
+        }
+
+        void grayScalar(const std::uint8_t* r, const std::uint8_t* g, const std::uint8_t* b, std::uint8_t* out, std::size_t n) {
+            for (std::size_t x = 0; x < n; ++x) out[x] = grayPixel(r[x], g[x], b[x]);
+        }
+
+        void blurHScalar(const std::uint8_t* in, const BlurKernel& k, std::uint8_t* out, std::size_t n) {
+            for (std::size_t x = 0; x < n; ++x) {
+                const std::uint8_t* p = in + x;
+                std::uint32_t s = k.w[0] * p[0];
+                for (int i = 1; i <= k.radius; ++i) s += k.w[i] * (p[-i] + p[i]);
+                out[x] = static_cast<std::uint8_t>((s + 128) >> 8);
+            }
+        }
+
+        void blurVScalar(const std::uint8_t* const* rows, const BlurKernel& k, std::uint8_t* out, std::size_t n) {
+            const std::uint8_t* const* c = rows + k.radius;
+            for (std::size_t x = 0; x < n; ++x) {
+                std::uint32_t s = k.w[0] * c[0][x];
+                for (int i = 1; i <= k.radius; ++i) s += k.w[i] * (c[-i][x] + c[i][x]);
+                out[x] = static_cast<std::uint8_t>((s + 128) >> 8);
+            }
+        }
+
+        void sobelScalar(const std::uint8_t* a, const std::uint8_t* r, const std::uint8_t* b, std::uint8_t* out, std::size_t n) {
+            sobelColumns(a, r, b, out, n, 0, n);
+        }
+
+        void thresholdScalar(const std::uint8_t* in, std::uint8_t t, std::uint8_t* out, std::size_t n) {
+            for (std::size_t x = 0; x < n; ++x) out[x] = (in[x] >= t) ? 255 : 0;
+        }
+
+        void integralScalar(const std::uint8_t* in, const std::uint32_t* above, std::uint32_t* out, std::size_t n) {
+            std::uint32_t run = 0;
+            for (std::size_t x = 0; x < n; ++x) {
+                run += in[x];
+                out[x] = above[x] + run;
+            }
+        }
+
+        void addRowScalar(const std::uint32_t* offset, std::uint32_t* row, std::size_t n) {
+            for (std::size_t x = 0; x < n; ++x) row[x] += offset[x];
+        }
+
+#if IMAGE_HAS_X86_SIMD
+        __attribute__((target("avx2")))
+        inline __m256i load16(const std::uint8_t* p) {
+            return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        }
+
+        // Sixteen 16-bit lanes saturated to bytes and stored
+        __attribute__((target("avx2")))
+        inline void store16(std::uint8_t* p, __m256i v) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                             _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i round256(__m256i s) {
+            return _mm256_srli_epi16(_mm256_add_epi16(s, _mm256_set1_epi16(128)), 8);
+        }
+
+        __attribute__((target("avx2")))
+        void grayAvx2(const std::uint8_t* r, const std::uint8_t* g, const std::uint8_t* b, std::uint8_t* out, std::size_t n) {
+            const __m256i wr = _mm256_set1_epi16(77), wg = _mm256_set1_epi16(150), wb = _mm256_set1_epi16(29);
+            std::size_t x = 0;
+            for (; x + 16 <= n; x += 16) {
+                const __m256i s = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(load16(r + x), wr),
+                                                                    _mm256_mullo_epi16(load16(g + x), wg)),
+                                                   _mm256_mullo_epi16(load16(b + x), wb));
+                store16(out + x, round256(s));
+            }
+            grayScalar(r + x, g + x, b + x, out + x, n - x);
+        }
+
+        // Sums stay below 2^16 because the weights add up to 256
+        __attribute__((target("avx2")))
+        void blurHAvx2(const std::uint8_t* in, const BlurKernel& k, std::uint8_t* out, std::size_t n) {
+            __m256i w[maxBlurRadius + 1];
+            for (int i = 0; i <= k.radius; ++i) w[i] = _mm256_set1_epi16(static_cast<short>(k.w[i]));
+            std::size_t x = 0;
+            for (; x + 16 <= n; x += 16) {
+                const std::uint8_t* p = in + x;
+                __m256i s = _mm256_mullo_epi16(load16(p), w[0]);
+                for (int i = 1; i <= k.radius; ++i) {
+                    s = _mm256_add_epi16(s, _mm256_mullo_epi16(_mm256_add_epi16(load16(p - i), load16(p + i)), w[i]));
+                }
+                store16(out + x, round256(s));
+            }
+            blurHScalar(in + x, k, out + x, n - x);
+        }
+
+        __attribute__((target("avx2")))
+        void blurVAvx2(const std::uint8_t* const* rows, const BlurKernel& k, std::uint8_t* out, std::size_t n) {
+            __m256i w[maxBlurRadius + 1];
+            for (int i = 0; i <= k.radius; ++i) w[i] = _mm256_set1_epi16(static_cast<short>(k.w[i]));
+            const std::uint8_t* const* c = rows + k.radius;
+            std::size_t x = 0;
+            for (; x + 16 <= n; x += 16) {
+                __m256i s = _mm256_mullo_epi16(load16(c[0] + x), w[0]);
+                for (int i = 1; i <= k.radius; ++i) {
+                    s = _mm256_add_epi16(s, _mm256_mullo_epi16(_mm256_add_epi16(load16(c[-i] + x), load16(c[i] + x)), w[i]));
+                }
+                store16(out + x, round256(s));
+            }
+            const std::uint8_t* tail[2 * maxBlurRadius + 1];
+            for (int i = 0; i <= 2 * k.radius; ++i) tail[i] = rows[i] + x;
+            blurVScalar(tail, k, out + x, n - x);
+        }
+
+        __attribute__((target("avx2")))
+        void sobelAvx2(const std::uint8_t* a, const std::uint8_t* r, const std::uint8_t* b, std::uint8_t* out, std::size_t n) {
+            if (n < 18) {
+                sobelColumns(a, r, b, out, n, 0, n);
+                return;
+            }
+            sobelColumns(a, r, b, out, n, 0, 1);
+            std::size_t x = 1;
+            for (; x + 17 <= n; x += 16) {
+                const __m256i al = load16(a + x - 1), ac = load16(a + x), ah = load16(a + x + 1);
+                const __m256i rl = load16(r + x - 1), rh = load16(r + x + 1);
+                const __m256i bl = load16(b + x - 1), bc = load16(b + x), bh = load16(b + x + 1);
+                const __m256i gx = _mm256_add_epi16(_mm256_add_epi16(_mm256_sub_epi16(ah, al), _mm256_sub_epi16(bh, bl)),
+                                                    _mm256_slli_epi16(_mm256_sub_epi16(rh, rl), 1));
+                const __m256i gy = _mm256_sub_epi16(_mm256_add_epi16(_mm256_add_epi16(bl, bh), _mm256_slli_epi16(bc, 1)),
+                                                    _mm256_add_epi16(_mm256_add_epi16(al, ah), _mm256_slli_epi16(ac, 1)));
+                store16(out + x, _mm256_add_epi16(_mm256_abs_epi16(gx), _mm256_abs_epi16(gy)));
+            }
+            sobelColumns(a, r, b, out, n, x, n);
+        }
+
+        __attribute__((target("avx2")))
+        void thresholdAvx2(const std::uint8_t* in, std::uint8_t t, std::uint8_t* out, std::size_t n) {
+            const __m256i tv = _mm256_set1_epi8(static_cast<char>(t));
+            std::size_t x = 0;
+            for (; x + 32 <= n; x += 32) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + x));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), _mm256_cmpeq_epi8(_mm256_max_epu8(v, tv), v));
+            }
+            thresholdScalar(in + x, t, out + x, n - x);
+        }
+
+        // Eight pixels per step: an in-register prefix sum (two shifted adds per
+        // 128-bit half, then the low half's total into the high half) plus the
+        // running total of the row so far, broadcast from the previous step
+        __attribute__((target("avx2")))
+        void integralAvx2(const std::uint8_t* in, const std::uint32_t* above, std::uint32_t* out, std::size_t n) {
+            const __m256i lowTotal = _mm256_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3), last = _mm256_set1_epi32(7);
+            __m256i run = _mm256_setzero_si256();
+            std::size_t x = 0;
+            for (; x + 8 <= n; x += 8) {
+                __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + x)));
+                v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+                v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+                v = _mm256_add_epi32(v, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permutevar8x32_epi32(v, lowTotal), 0xf0));
+                v = _mm256_add_epi32(v, run);
+                run = _mm256_permutevar8x32_epi32(v, last);
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + x));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), _mm256_add_epi32(v, a));
+            }
+            std::uint32_t total = static_cast<std::uint32_t>(_mm256_cvtsi256_si32(run));
+            for (; x < n; ++x) {
+                total += in[x];
+                out[x] = above[x] + total;
+            }
+        }
+
+        __attribute__((target("avx2")))
+        void addRowAvx2(const std::uint32_t* offset, std::uint32_t* row, std::size_t n) {
+            std::size_t x = 0;
+            for (; x + 8 <= n; x += 8) {
+                const __m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset + x));
+                __m256i* p = reinterpret_cast<__m256i*>(row + x);
+                _mm256_storeu_si256(p, _mm256_add_epi32(_mm256_loadu_si256(p), o));
+            }
+            addRowScalar(offset + x, row + x, n - x);
+        }
+#endif
+
+        struct Kernels {
+            GrayKernel gray;
+            BlurHKernel blurH;
+            BlurVKernel blurV;
+            SobelKernel sobel;
+            ThresholdKernel threshold;
+            IntegralKernel integral;
+            AddRowKernel addRow;
+            const char* name;
+        };
+
+        Kernels selectKernels(bool forceScalar) {
+#if IMAGE_HAS_X86_SIMD
+            __builtin_cpu_init();
+            if (!forceScalar && __builtin_cpu_supports("avx2")) {
+                return {grayAvx2, blurHAvx2, blurVAvx2, sobelAvx2, thresholdAvx2, integralAvx2, addRowAvx2, "avx2"};
+            }
+#else
+            (void)forceScalar;
+#endif
+            return {grayScalar, blurHScalar, blurVScalar, sobelScalar, thresholdScalar, integralScalar, addRowScalar, "scalar"};
+        }
+
+        // Threads owned by one processor; run(job) calls job(t) for every worker
+        // t, with the calling thread as worker 0, and returns when all are done
+        class WorkerPool {
+            std::vector<std::thread> threads_;
+            std::mutex mutex_;
+            std::condition_variable wake_, done_;
+            const std::function<void(unsigned)>* job_ = nullptr;
+            std::uint64_t generation_ = 0;
+            unsigned pending_ = 0;
+            bool stop_ = false;
+
+            void loop(unsigned t) {
+                for (std::uint64_t seen = 0;;) {
+                    const std::function<void(unsigned)>* job;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                        if (stop_) return;
+                        seen = generation_;
+                        job = job_;
+                    }
+                    (*job)(t);
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (--pending_ == 0) done_.notify_one();
+                }
+            }
+
+        public:
+            explicit WorkerPool(unsigned threads) {
+                for (unsigned t = 1; t < threads; ++t) threads_.emplace_back(&WorkerPool::loop, this, t);
+            }
+
+            ~WorkerPool() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stop_ = true;
+                }
+                wake_.notify_all();
+                for (auto& th : threads_) th.join();
+            }
+
+            WorkerPool(const WorkerPool&) = delete;
+            WorkerPool& operator=(const WorkerPool&) = delete;
+
+            unsigned size() const { return static_cast<unsigned>(threads_.size()) + 1; }
+
+            void run(const std::function<void(unsigned)>& job) {
+                if (!threads_.empty()) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    job_ = &job;
+                    pending_ = static_cast<unsigned>(threads_.size());
+                    ++generation_;
+                }
+                wake_.notify_all();
+                job(0);
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_.wait(lock, [&] { return pending_ == 0; });
+            }
+        };
+
+        bool valid(const ImageDesc& image) {
+            if (image.width == 0 || image.height == 0 || image.stride < image.width) return false;
+            if (image.planeCount != 1 && image.planeCount != 3) return false;
+            for (std::uint32_t p = 0; p < image.planeCount; ++p) {
+                if (!image.planes[p]) return false;
+            }
+            return true;
+        }
+
+        // One step of a pipeline. A filter turns 2 radius() + 1 consecutive
+        // input rows into one output row; scratch holds at least
+        // width + 2 maxBlurRadius bytes private to the calling thread.
+        class Filter {
+        public:
+            virtual ~Filter() = default;
+            // Rows above and below the output row that row() reads
+            virtual int radius() const = 0;
+            // rows[k] is input row y - radius() + k, clamped to the image
+            virtual void row(const std::uint8_t* const* rows, std::uint8_t* out, std::size_t n,
+                             std::uint8_t* scratch) const = 0;
+        };
+
+        class BlurH final : public Filter {
+            BlurHKernel kernel_;
+            BlurKernel weights_;
+        public:
+            BlurH(BlurHKernel kernel, const BlurKernel& weights) : kernel_(kernel), weights_(weights) {}
+            int radius() const override { return 0; }
+            void row(const std::uint8_t* const* rows, std::uint8_t* out, std::size_t n, std::uint8_t* scratch) const override {
+                const int r = weights_.radius;
+                std::uint8_t* pad = scratch + maxBlurRadius;
+                std::copy(rows[0], rows[0] + n, pad);
+                std::fill(pad - r, pad, rows[0][0]);
+                std::fill(pad + n, pad + n + r, rows[0][n - 1]);
+                kernel_(pad, weights_, out, n);
+            }
+        };
+
+        class BlurV final : public Filter {
+            BlurVKernel kernel_;
+            BlurKernel weights_;
+        public:
+            BlurV(BlurVKernel kernel, const BlurKernel& weights) : kernel_(kernel), weights_(weights) {}
+            int radius() const override { return weights_.radius; }
+            void row(const std::uint8_t* const* rows, std::uint8_t* out, std::size_t n, std::uint8_t*) const override {
+                kernel_(rows, weights_, out, n);
+            }
+        };
+
+        class Sobel final : public Filter {
+            SobelKernel kernel_;
+        public:
+            explicit Sobel(SobelKernel kernel) : kernel_(kernel) {}
+            int radius() const override { return 1; }
+            void row(const std::uint8_t* const* rows, std::uint8_t* out, std::size_t n, std::uint8_t*) const override {
+                kernel_(rows[0], rows[1], rows[2], out, n);
+            }
+        };
+
+        class Threshold final : public Filter {
+            ThresholdKernel kernel_;
+            std::uint8_t t_;
+        public:
+            Threshold(ThresholdKernel kernel, std::uint8_t t) : kernel_(kernel), t_(t) {}
+            int radius() const override { return 0; }
+            void row(const std::uint8_t* const* rows, std::uint8_t* out, std::size_t n, std::uint8_t*) const override {
+                kernel_(rows[0], t_, out, n);
+            }
+        };
+
+        // Filters applied one after another to a single-plane image
+        class Pipeline {
+            std::vector<std::unique_ptr<Filter>> filters_;
+        public:
+            Pipeline& then(std::unique_ptr<Filter> filter) {
+                filters_.push_back(std::move(filter));
+                return *this;
+            }
+
+            // Separable Gaussian as a horizontal and a vertical pass
+            Pipeline& gaussian(const Kernels& k, float sigma) {
+                const BlurKernel weights = makeBlurKernel(sigma);
+                if (weights.radius == 0) return *this;
+                then(std::make_unique<BlurH>(k.blurH, weights));
+                return then(std::make_unique<BlurV>(k.blurV, weights));
+            }
+
+            std::size_t size() const { return filters_.size(); }
+            const Filter& operator[](std::size_t i) const { return *filters_[i]; }
+        };
+    }
+
+    class ImageProcessorImpl final : public IImageProcessor {
+        detail::Kernels kernels_;
+        detail::Pipeline pipeline_;
+        bool fused_;
+        detail::WorkerPool pool_;
+        std::uint32_t width_ = 0, height_ = 0;
+        std::vector<std::uint8_t> scratch_;                   // per worker
+        std::vector<std::vector<std::uint8_t>> frames_;       // unfused: one image per stage
+        std::vector<std::vector<std::uint8_t>> lines_;        // fused: rolling line buffers per worker
+        std::vector<std::vector<const std::uint8_t*>> slots_; // fused: row pointers into lines_, per worker
+
+        std::size_t scratchSize() const { return width_ + 2 * detail::maxBlurRadius; }
+
+        void resize(std::uint32_t width, std::uint32_t height) {
+            if (width == width_ && height == height_) return;
+            width_ = width;
+            height_ = height;
+            scratch_.assign(pool_.size() * scratchSize(), 0);
+            frames_.clear();
+            lines_.clear();
+            slots_.clear();
+        }
+
+        // Row y of the pipeline input: a plane of in, or the grayscale of its
+        // three planes written to buffer
+        const std::uint8_t* sourceRow(const ImageDesc& in, std::uint32_t y, std::uint8_t* buffer) const {
+            const std::size_t o = static_cast<std::size_t>(y) * in.stride;
+            if (in.planeCount == 1) return in.planes[0] + o;
+            kernels_.gray(in.planes[0] + o, in.planes[1] + o, in.planes[2] + o, buffer, width_);
+            return buffer;
+        }
+
+        std::uint8_t* outputRow(const ImageDesc& out, std::uint32_t y) const {
+            return out.planes[0] + static_cast<std::size_t>(y) * out.stride;
+        }
+
+        // Stage by stage over the whole frame; every intermediate is a full image
+        void runUnfused(const ImageDesc& in, const ImageDesc& out) {
+            const std::size_t w = width_, stages = pipeline_.size();
+            frames_.resize(stages);
+            for (auto& f : frames_) f.resize(w * height_);
+            const unsigned workers = pool_.size();
+            const std::uint32_t h = height_;
+            auto forEachRow = [&](auto rowFn) {
+                pool_.run([&](unsigned t) {
+                    for (std::uint32_t y = h * t / workers, end = h * (t + 1) / workers; y < end; ++y) rowFn(t, y);
+                });
+            };
+
+            forEachRow([&](unsigned, std::uint32_t y) {
+                std::uint8_t* dst = frames_[0].data() + y * w;
+                const std::uint8_t* src = sourceRow(in, y, dst);
+                if (src != dst) std::copy(src, src + w, dst);
+            });
+            for (std::size_t s = 0; s < stages; ++s) {
+                const detail::Filter& filter = pipeline_[s];
+                const std::uint8_t* input = frames_[s].data();
+                forEachRow([&](unsigned t, std::uint32_t y) {
+                    const int r = filter.radius();
+                    const std::uint8_t* rows[2 * detail::maxBlurRadius + 1];
+                    for (int k = 0; k <= 2 * r; ++k) {
+                        const std::int64_t yy = std::min<std::int64_t>(std::max<std::int64_t>(std::int64_t(y) - r + k, 0), h - 1);
+                        rows[k] = input + yy * w;
+                    }
+                    std::uint8_t* dst = (s + 1 == stages) ? outputRow(out, y) : frames_[s + 1].data() + y * w;
+                    filter.row(rows, dst, w, scratch_.data() + t * scratchSize());
+                });
+            }
+        }
+
+        // All stages at once over strips of rows. Stage s keeps only the
+        // 2 r + 1 rows stage s + 1 reads (r = that stage's radius) in a ring,
+        // and rows are produced on demand, so intermediates stay in cache.
+        // Each strip recomputes the halo rows above it that its stages need.
+        void runFused(const ImageDesc& in, const ImageDesc& out) {
+            const std::size_t w = width_, stages = pipeline_.size();
+            const std::uint32_t h = height_;
+
+            // Ring capacity per level: level 0 is the source, level s + 1 the output of filter s
+            std::vector<std::uint32_t> capacity(stages), halo(stages + 1, 0);
+            for (std::size_t s = 0; s < stages; ++s) capacity[s] = 2 * pipeline_[s].radius() + 1;
+            for (std::size_t s = stages; s-- > 0;) halo[s] = halo[s + 1] + pipeline_[s].radius();
+            std::size_t ringRows = 0;
+            for (std::uint32_t c : capacity) ringRows += c;
+            if (lines_.size() != pool_.size()) {
+                lines_.assign(pool_.size(), std::vector<std::uint8_t>(ringRows * w));
+                slots_.assign(pool_.size(), std::vector<const std::uint8_t*>(ringRows));
+            }
+
+            // About four strips per worker for balance; each strip pays for its halo once
+            const std::uint32_t stripRows = std::max(64u, (h + 4 * pool_.size() - 1) / (4 * pool_.size()));
+            const std::uint32_t strips = (h + stripRows - 1) / stripRows;
+            std::atomic<std::uint32_t> nextStrip{0};
+            pool_.run([&](unsigned t) {
+                std::uint8_t* scratch = scratch_.data() + t * scratchSize();
+                std::vector<std::uint8_t*> rings(stages);
+                std::vector<const std::uint8_t**> slots(stages);
+                for (std::size_t s = 0, offset = 0; s < stages; offset += capacity[s], ++s) {
+                    rings[s] = lines_[t].data() + offset * w;
+                    slots[s] = slots_[t].data() + offset;
+                }
+                std::vector<std::uint32_t> next(stages + 1);
+
+                // Makes row y of level l available, producing lower levels as needed
+                std::function<void(std::size_t, std::uint32_t)> produce;
+                auto ensure = [&](std::size_t level, std::uint32_t upTo) {
+                    while (next[level] <= upTo) produce(level, next[level]++);
+                };
+                produce = [&](std::size_t level, std::uint32_t y) {
+                    if (level == 0) {
+                        std::uint8_t* line = rings[0] + (y % capacity[0]) * w;
+                        slots[0][y % capacity[0]] = sourceRow(in, y, line);
+                        return;
+                    }
+                    const std::size_t s = level - 1;
+                    const int r = pipeline_[s].radius();
+                    ensure(s, std::min<std::uint32_t>(h - 1, y + r));
+                    const std::uint8_t* rows[2 * detail::maxBlurRadius + 1];
+                    for (int k = 0; k <= 2 * r; ++k) {
+                        const std::int64_t yy = std::min<std::int64_t>(std::max<std::int64_t>(std::int64_t(y) - r + k, 0), h - 1);
+                        rows[k] = slots[s][yy % capacity[s]];
+                    }
+                    if (level == stages) {
+                        pipeline_[s].row(rows, outputRow(out, y), w, scratch);
+                    } else {
+                        std::uint8_t* line = rings[level] + (y % capacity[level]) * w;
+                        pipeline_[s].row(rows, line, w, scratch);
+                        slots[level][y % capacity[level]] = line;
+                    }
+                };
+
+                for (std::uint32_t strip; (strip = nextStrip.fetch_add(1)) < strips;) {
+                    const std::uint32_t y0 = strip * stripRows, y1 = std::min(h, y0 + stripRows);
+                    for (std::size_t level = 0; level <= stages; ++level) {
+                        next[level] = y0 > halo[level] ? y0 - halo[level] : 0;
+                    }
+                    for (std::uint32_t y = y0; y < y1; ++y) produce(stages, y);
+                }
+            });
+        }
+
+    public:
+        ImageProcessorImpl(const ProcessorConfig& config, unsigned threads)
+            : kernels_(detail::selectKernels(config.flags & forceScalar)),
+              fused_(!(config.flags & unfused)),
+              pool_(threads) {
+            pipeline_.gaussian(kernels_, config.blurSigma)
+                .then(std::make_unique<detail::Sobel>(kernels_.sobel))
+                .then(std::make_unique<detail::Threshold>(kernels_.threshold, static_cast<std::uint8_t>(config.threshold)));
+        }
+
+        Status process(const ImageDesc& in, const ImageDesc& out) override {
+            if (!detail::valid(in) || !detail::valid(out)) return Status::invalidImage;
+            if (out.planeCount != 1 || out.width != in.width || out.height != in.height) return Status::sizeMismatch;
+            resize(in.width, in.height);
+            if (fused_) {
+                runFused(in, out);
+            } else {
+                runUnfused(in, out);
+            }
+            return Status::ok;
+        }
+
+        const char* kernelName() const override { return kernels_.name; }
+
+        void release() override {
+            delete this;  // Same module that allocated it
+        }
+    };
+
+    ProcessorConfig defaultProcessorConfig() {
+        return {sizeof(ProcessorConfig), 1.4f, 96, 0, 0};
+    }
+
+    IImageProcessor* createProcessor(const ProcessorConfig& config) {
+        if (config.structSize != sizeof(ProcessorConfig)) return nullptr;
+        if (!(config.blurSigma >= 0.0f) || config.threshold > 255) return nullptr;
+        const unsigned threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+        return new (std::nothrow) ImageProcessorImpl(config, threads);
+    }
+
+    class ImageAnalyzerImpl final : public IImageAnalyzer {
+        detail::Kernels kernels_;
+        detail::WorkerPool pool_;
+        std::vector<std::uint32_t> zeros_;     // an all-zero row above each band
+        std::vector<std::uint32_t> offsets_;   // per band: table row above it, summed over earlier bands
+        std::vector<std::uint32_t> counts_;    // per worker: four interleaved 256-bin histograms
+
+        static constexpr std::size_t countsPerWorker = 4 * 256 + 16;   // padded to keep workers off each other's lines
+
+        // Rows [begin, end) of band t of height rows
+        std::uint32_t bandBegin(unsigned t, std::uint32_t height) const {
+            return static_cast<std::uint32_t>(std::uint64_t(height) * t / pool_.size());
+        }
+
+    public:
+        ImageAnalyzerImpl(const AnalyzerConfig& config, unsigned threads)
+            : kernels_(detail::selectKernels(config.flags & forceScalar)), pool_(threads),
+              counts_(threads * countsPerWorker) {}
+
+        // Two passes over bands of rows. First each band builds its own table
+        // as if it started at the top of the image. Then the bottom rows of the
+        // bands are summed serially into per-band offsets, and each band adds
+        // its offset to all of its rows.
+        Status integral(const ImageDesc& in, std::uint32_t plane, const IntegralDesc& out) override {
+            if (!detail::valid(in) || !out.data) return Status::invalidImage;
+            if (plane >= in.planeCount) return Status::invalidPlane;
+            if (out.width != in.width + 1 || out.height != in.height + 1 || out.stride < out.width) {
+                return Status::sizeMismatch;
+            }
+            const std::size_t w = in.width, stride = out.stride;
+            const unsigned bands = pool_.size();
+            if (zeros_.size() < w) zeros_.assign(w, 0);
+            offsets_.resize(bands * w);
+            std::fill(out.data, out.data + out.width, 0u);
+
+            pool_.run([&](unsigned t) {
+                const std::uint32_t begin = bandBegin(t, in.height), end = bandBegin(t + 1, in.height);
+                for (std::uint32_t y = begin; y < end; ++y) {
+                    std::uint32_t* row = out.data + (y + 1) * stride;
+                    row[0] = 0;
+                    kernels_.integral(in.planes[plane] + static_cast<std::size_t>(y) * in.stride,
+                                      y == begin ? zeros_.data() : row - stride + 1, row + 1, w);
+                }
+            });
+
+            std::fill(offsets_.begin(), offsets_.begin() + w, 0u);
+            for (unsigned b = 1; b < bands; ++b) {
+                std::uint32_t* offset = offsets_.data() + b * w;
+                std::copy(offset - w, offset, offset);
+                if (bandBegin(b, in.height) > bandBegin(b - 1, in.height)) {
+                    kernels_.addRow(out.data + bandBegin(b, in.height) * stride + 1, offset, w);
+                }
+            }
+
+            pool_.run([&](unsigned t) {
+                if (t == 0) return;
+                const std::uint32_t* offset = offsets_.data() + t * w;
+                for (std::uint32_t y = bandBegin(t, in.height), end = bandBegin(t + 1, in.height); y < end; ++y) {
+                    kernels_.addRow(offset, out.data + (y + 1) * stride + 1, w);
+                }
+            });
+            return Status::ok;
+        }
+
+        // Every worker counts its band into private histograms, four of them
+        // interleaved so runs of equal pixels do not serialize on one counter;
+        // the private counts are summed at the end, so no atomics are needed
+        Status histogram(const ImageDesc& in, std::uint32_t plane, std::uint32_t* bins) override {
+            if (!detail::valid(in) || !bins) return Status::invalidImage;
+            if (plane >= in.planeCount) return Status::invalidPlane;
+            const std::size_t w = in.width;
+            pool_.run([&](unsigned t) {
+                std::uint32_t* c = counts_.data() + t * countsPerWorker;
+                std::fill(c, c + 4 * 256, 0u);
+                for (std::uint32_t y = bandBegin(t, in.height), end = bandBegin(t + 1, in.height); y < end; ++y) {
+                    const std::uint8_t* row = in.planes[plane] + static_cast<std::size_t>(y) * in.stride;
+                    std::size_t x = 0;
+                    for (; x + 4 <= w; x += 4) {
+                        ++c[row[x]];
+                        ++c[256 + row[x + 1]];
+                        ++c[512 + row[x + 2]];
+                        ++c[768 + row[x + 3]];
+                    }
+                    for (; x < w; ++x) ++c[row[x]];
+                }
+            });
+            std::fill(bins, bins + 256, 0u);
+            for (unsigned t = 0; t < pool_.size(); ++t) {
+                const std::uint32_t* c = counts_.data() + t * countsPerWorker;
+                for (int v = 0; v < 256; ++v) bins[v] += c[v] + c[256 + v] + c[512 + v] + c[768 + v];
+            }
+            return Status::ok;
+        }
+
+        const char* kernelName() const override { return kernels_.name; }
+
+        void release() override {
+            delete this;  // Same module that allocated it
+        }
+    };
+
+    AnalyzerConfig defaultAnalyzerConfig() {
+        return {sizeof(AnalyzerConfig), 0, 0};
+    }
+
+    IImageAnalyzer* createAnalyzer(const AnalyzerConfig& config) {
+        if (config.structSize != sizeof(AnalyzerConfig)) return nullptr;
+        const unsigned threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+        return new (std::nothrow) ImageAnalyzerImpl(config, threads);
+    }
+}
+
+// Client code: owns its images and only talks to the module through the header
+namespace client_code {
+    struct PlanarImage {
+        std::uint32_t width, height, stride;
+        std::vector<std::uint8_t> data;
+
+        PlanarImage(std::uint32_t w, std::uint32_t h, std::uint32_t planes)
+            : width(w), height(h), stride((w + 63) & ~63u), data(static_cast<std::size_t>(stride) * h * planes, 0) {}
+
+        dll_interface::ImageDesc desc() {
+            const std::uint32_t planes = static_cast<std::uint32_t>(data.size() / (static_cast<std::size_t>(stride) * height));
+            dll_interface::ImageDesc d{width, height, stride, planes, {nullptr, nullptr, nullptr}};
+            for (std::uint32_t p = 0; p < planes; ++p) d.planes[p] = data.data() + static_cast<std::size_t>(p) * stride * height;
+            return d;
+        }
+    };
+
+    // Shaded background, noise and a few filled discs, so there are edges to find
+    PlanarImage syntheticFrame(std::uint32_t w, std::uint32_t h, unsigned seed) {
+        PlanarImage img(w, h, 3);
+        dll_interface::ImageDesc d = img.desc();
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> noise(-12, 12), cx(0, static_cast<int>(w) - 1), cy(0, static_cast<int>(h) - 1);
+        struct Disc { int x, y, r, c; };
+        std::vector<Disc> discs;
+        for (int i = 0; i < 40; ++i) discs.push_back({cx(rng), cy(rng), 20 + i * 4, 40 + i * 5});
+        for (std::uint32_t y = 0; y < h; ++y) {
+            for (std::uint32_t x = 0; x < w; ++x) {
+                int v = static_cast<int>(64 + 64 * x / w + 32 * y / h);
+                for (const Disc& disc : discs) {
+                    const int dx = static_cast<int>(x) - disc.x, dy = static_cast<int>(y) - disc.y;
+                    if (dx * dx + dy * dy < disc.r * disc.r) v = disc.c;
+                }
+                for (int p = 0; p < 3; ++p) {
+                    d.planes[p][static_cast<std::size_t>(y) * img.stride + x] =
+                        static_cast<std::uint8_t>(std::min(255, std::max(0, v + 30 * (p - 1) + noise(rng))));
+                }
+            }
+        }
+        return img;
+    }
+
+    bool sameMask(const PlanarImage& a, const PlanarImage& b) {
+        for (std::uint32_t y = 0; y < a.height; ++y) {
+            if (!std::equal(a.data.begin() + static_cast<std::ptrdiff_t>(y) * a.stride,
+                            a.data.begin() + static_cast<std::ptrdiff_t>(y) * a.stride + a.width,
+                            b.data.begin() + static_cast<std::ptrdiff_t>(y) * b.stride)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    struct Table {
+        std::uint32_t width, height;
+        std::vector<std::uint32_t> data;
+
+        Table(std::uint32_t w, std::uint32_t h) : width(w + 1), height(h + 1), data(static_cast<std::size_t>(w + 1) * (h + 1), 0) {}
+
+        dll_interface::IntegralDesc desc() { return {width, height, width, data.data()}; }
+    };
+
+    // 255 where a pixel is brighter than the mean of its (2r + 1)^2 window, less
+    // bias; windows are clipped to the image. Compared as pixel * area + bias * area > sum.
+    inline std::uint8_t localMeanPixel(std::uint32_t pixel, std::uint32_t sum, std::uint32_t area, std::uint32_t bias) {
+        return (static_cast<std::uint64_t>(pixel + bias) * area > sum) ? 255 : 0;
+    }
+
+    // O(r^2) per pixel
+    void localMeanDirect(const std::uint8_t* img, std::uint32_t stride, std::uint32_t w, std::uint32_t h,
+                         std::uint32_t r, std::uint32_t bias, std::uint8_t* out) {
+        for (std::uint32_t y = 0; y < h; ++y) {
+            const std::uint32_t y0 = y > r ? y - r : 0, y1 = std::min(h, y + r + 1);
+            for (std::uint32_t x = 0; x < w; ++x) {
+                const std::uint32_t x0 = x > r ? x - r : 0, x1 = std::min(w, x + r + 1);
+                std::uint32_t sum = 0;
+                for (std::uint32_t yy = y0; yy < y1; ++yy) {
+                    for (std::uint32_t xx = x0; xx < x1; ++xx) sum += img[static_cast<std::size_t>(yy) * stride + xx];
+                }
+                out[static_cast<std::size_t>(y) * w + x] =
+                    localMeanPixel(img[static_cast<std::size_t>(y) * stride + x], sum, (x1 - x0) * (y1 - y0), bias);
+            }
+        }
+    }
+
+    // O(1) per pixel from the summed-area table
+    void localMeanIntegral(const std::uint8_t* img, std::uint32_t stride, const dll_interface::IntegralDesc& table,
+                           std::uint32_t r, std::uint32_t bias, std::uint8_t* out) {
+        const std::uint32_t w = table.width - 1, h = table.height - 1;
+        for (std::uint32_t y = 0; y < h; ++y) {
+            const std::uint32_t y0 = y > r ? y - r : 0, y1 = std::min(h, y + r + 1);
+            for (std::uint32_t x = 0; x < w; ++x) {
+                const std::uint32_t x0 = x > r ? x - r : 0, x1 = std::min(w, x + r + 1);
+                out[static_cast<std::size_t>(y) * w + x] =
+                    localMeanPixel(img[static_cast<std::size_t>(y) * stride + x], dll_interface::boxSum(table, x0, y0, x1, y1),
+                                   (x1 - x0) * (y1 - y0), bias);
+            }
+        }
+    }
+
+    struct Run {
+        const char* kernel;
+        double msPerFrame;
+    };
+
+    // Median time per frame, which shrugs off the odd descheduled frame
+    Run benchmark(const dll_interface::ProcessorConfig& config, PlanarImage& frame, PlanarImage& mask, int frames) {
+        dll_interface::IImageProcessor* proc = dll_interface::createProcessor(config);
+        if (!proc) return {"invalid config", 0.0};
+        const dll_interface::ImageDesc in = frame.desc(), out = mask.desc();
+        proc->process(in, out);   // warm-up: sizes the scratch buffers
+        std::vector<double> times;
+        for (int i = 0; i < frames; ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            proc->process(in, out);
+            auto t1 = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        const Run run{proc->kernelName(), times[times.size() / 2]};
+        proc->release();   // GOOD: freed by the module that allocated it
+        return run;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int frames = std::max(1, (argc > 1) ? std::atoi(argv[1]) : 100);
+    const std::uint32_t width = 1920, height = 1080;
+
+    client_code::PlanarImage frame = client_code::syntheticFrame(width, height, 60);
+    client_code::PlanarImage scalarMask(width, height, 1), mask(width, height, 1);
+
+    dll_interface::ProcessorConfig config = dll_interface::defaultProcessorConfig();
+    config.threads = 1;
+    config.flags = dll_interface::forceScalar;
+    const client_code::Run scalar = client_code::benchmark(config, frame, scalarMask, frames);
+    std::cout << width << "x" << height << " RGB, sigma " << config.blurSigma << ", threshold " << config.threshold << "\n";
+    std::cout << "  " << scalar.kernel << ", 1 thread: " << scalar.msPerFrame << " ms/frame ("
+              << 1000.0 / scalar.msPerFrame << " FPS)\n";
+
+    config.flags = 0;
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1;; threads = std::min(hardware, threads * 2)) {
+        config.threads = threads;
+        std::fill(mask.data.begin(), mask.data.end(), 0);
+        const client_code::Run run = client_code::benchmark(config, frame, mask, frames);
+        std::cout << "  " << run.kernel << ", " << threads << " thread(s): " << run.msPerFrame << " ms/frame ("
+                  << 1000.0 / run.msPerFrame << " FPS, identical to scalar: "
+                  << (client_code::sameMask(mask, scalarMask) ? "yes" : "no") << ")\n";
+        if (threads == hardware) break;
+    }
+
+    std::size_t edges = 0;
+    for (std::uint32_t y = 0; y < height; ++y) {
+        edges += static_cast<std::size_t>(std::count(scalarMask.data.begin() + static_cast<std::ptrdiff_t>(y) * scalarMask.stride,
+                                                     scalarMask.data.begin() + static_cast<std::ptrdiff_t>(y) * scalarMask.stride + width, 255));
+    }
+    std::cout << "  edge pixels: " << 100.0 * edges / (static_cast<double>(width) * height) << "%\n";
+
+    // Fused strips against one full-frame pass per stage, on 4K frames
+    const std::uint32_t width4k = 3840, height4k = 2160;
+    client_code::PlanarImage frame4k = client_code::syntheticFrame(width4k, height4k, 61);
+    client_code::PlanarImage unfusedMask(width4k, height4k, 1), fusedMask(width4k, height4k, 1);
+    config = dll_interface::defaultProcessorConfig();
+    config.flags = dll_interface::unfused;
+    const client_code::Run unfused = client_code::benchmark(config, frame4k, unfusedMask, frames / 4 + 1);
+    config.flags = 0;
+    const client_code::Run fused = client_code::benchmark(config, frame4k, fusedMask, frames / 4 + 1);
+    std::cout << width4k << "x" << height4k << " RGB, " << hardware << " thread(s), " << fused.kernel << "\n";
+    std::cout << "  unfused: " << unfused.msPerFrame << " ms/frame\n";
+    std::cout << "  fused:   " << fused.msPerFrame << " ms/frame (speedup " << unfused.msPerFrame / fused.msPerFrame
+              << ", identical: " << (client_code::sameMask(fusedMask, unfusedMask) ? "yes" : "no") << ")\n";
+
+    // Summed-area table and histogram of the 4K frame's green plane
+    const dll_interface::ImageDesc in4k = frame4k.desc();
+    client_code::Table expected(width4k, height4k), table(width4k, height4k);
+    for (std::uint32_t y = 0; y < height4k; ++y) {
+        std::uint32_t run = 0;
+        for (std::uint32_t x = 0; x < width4k; ++x) {
+            run += in4k.planes[1][static_cast<std::size_t>(y) * in4k.stride + x];
+            expected.data[(y + 1) * expected.width + x + 1] = expected.data[y * expected.width + x + 1] + run;
+        }
+    }
+    std::uint32_t expectedBins[256] = {};
+    for (std::uint32_t y = 0; y < height4k; ++y) {
+        for (std::uint32_t x = 0; x < width4k; ++x) ++expectedBins[in4k.planes[1][static_cast<std::size_t>(y) * in4k.stride + x]];
+    }
+
+    std::cout << width4k << "x" << height4k << " plane, integral image and 256-bin histogram\n";
+    dll_interface::AnalyzerConfig analyzerConfig = dll_interface::defaultAnalyzerConfig();
+    for (int pass = 0; pass < 2; ++pass) {
+        analyzerConfig.threads = pass == 0 ? 1 : hardware;
+        analyzerConfig.flags = pass == 0 ? std::uint32_t(dll_interface::forceScalar) : 0u;
+        dll_interface::IImageAnalyzer* analyzer = dll_interface::createAnalyzer(analyzerConfig);
+        std::uint32_t bins[256];
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames / 4 + 1; ++i) analyzer->integral(in4k, 1, table.desc());
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames / 4 + 1; ++i) analyzer->histogram(in4k, 1, bins);
+        auto t2 = std::chrono::steady_clock::now();
+        std::cout << "  " << analyzer->kernelName() << ", " << analyzerConfig.threads << " thread(s): integral "
+                  << std::chrono::duration<double, std::milli>(t1 - t0).count() / (frames / 4 + 1) << " ms (correct: "
+                  << (table.data == expected.data ? "yes" : "no") << "), histogram "
+                  << std::chrono::duration<double, std::milli>(t2 - t1).count() / (frames / 4 + 1) << " ms (correct: "
+                  << (std::equal(bins, bins + 256, expectedBins) ? "yes" : "no") << ")\n";
+        analyzer->release();
+    }
+
+    // Auto-exposure from the histogram: the 1st and 99th percentile levels
+    std::uint64_t seen = 0;
+    int low = -1, high = -1;
+    const std::uint64_t pixels4k = static_cast<std::uint64_t>(width4k) * height4k;
+    for (int v = 0; v < 256; ++v) {
+        seen += expectedBins[v];
+        if (low < 0 && seen * 100 >= pixels4k) low = v;
+        if (high < 0 && seen * 100 >= pixels4k * 99) high = v;
+    }
+    std::cout << "  exposure range (1st..99th percentile): " << low << ".." << high << "\n";
+
+    // Local-mean thresholding: window sums from the table instead of O(r^2) loops
+    const std::uint32_t radius = 7, bias = 4;
+    const dll_interface::ImageDesc in1080 = frame.desc();
+    client_code::Table table1080(width, height);
+    std::vector<std::uint8_t> direct(static_cast<std::size_t>(width) * height), boxed(direct.size());
+    dll_interface::IImageAnalyzer* analyzer = dll_interface::createAnalyzer(dll_interface::defaultAnalyzerConfig());
+    auto t0 = std::chrono::steady_clock::now();
+    client_code::localMeanDirect(in1080.planes[1], in1080.stride, width, height, radius, bias, direct.data());
+    auto t1 = std::chrono::steady_clock::now();
+    analyzer->integral(in1080, 1, table1080.desc());
+    client_code::localMeanIntegral(in1080.planes[1], in1080.stride, table1080.desc(), radius, bias, boxed.data());
+    auto t2 = std::chrono::steady_clock::now();
+    analyzer->release();
+    std::cout << width << "x" << height << " local-mean threshold, " << 2 * radius + 1 << "x" << 2 * radius + 1 << " window\n";
+    std::cout << "  direct window sums: " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+    std::cout << "  integral image:     " << std::chrono::duration<double, std::milli>(t2 - t1).count()
+              << " ms including the table (identical: " << (direct == boxed ? "yes" : "no") << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Good: Module interface that only passes fixed-width types and caller-owned buffers
+
+#ifndef IMAGE_PROCESSOR_H
+#define IMAGE_PROCESSOR_H
+
+#include <cstdint>
+
+namespace dll_interface {
+    // An 8-bit planar image owned by the caller. Row y of plane p starts at
+    // planes[p] + y * stride. The module reads and writes through these
+    // pointers but never allocates or frees them.
+    struct ImageDesc {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t stride;        // bytes between rows, at least width
+        std::uint32_t planeCount;    // 1 (gray) or 3 (R, G, B)
+        std::uint8_t* planes[3];
+    };
+
+    enum class Status : std::int32_t {
+        ok = 0,
+        invalidImage = 1,            // null plane, zero size or stride < width
+        sizeMismatch = 2,            // output does not match the input's size or plane count
+        invalidPlane = 3             // plane index not below the image's planeCount
+    };
+
+    enum ProcessorFlags : std::uint32_t {
+        forceScalar = 1u << 0,       // ignore AVX2 even when the CPU has it
+        unfused = 1u << 1            // run each stage over the whole frame in turn (for comparison)
+    };
+
+    struct ProcessorConfig {
+        std::uint32_t structSize;    // sizeof(ProcessorConfig) the caller was built with
+        float blurSigma;             // Gaussian sigma in pixels; 0 disables the blur
+        std::uint32_t threshold;     // gradient magnitudes at or above this become 255
+        std::uint32_t threads;       // worker threads; 0 means one per hardware thread
+        std::uint32_t flags;         // ProcessorFlags
+    };
+
+    class IImageProcessor {
+    public:
+        // Grayscale, Gaussian blur, Sobel gradient magnitude and threshold:
+        // reads in (1 or 3 planes) and writes a 0/255 edge mask to out's single plane
+        virtual Status process(const ImageDesc& in, const ImageDesc& out) = 0;
+        // "avx2" or "scalar"
+        virtual const char* kernelName() const = 0;
+        virtual void release() = 0;  // Frees the processor and its scratch memory in this module
+
+    protected:
+        virtual ~IImageProcessor() = default;  // Not deletable by clients
+    };
+
+    ProcessorConfig defaultProcessorConfig();
+
+    // Returns nullptr if config is invalid; release() the result when done
+    IImageProcessor* createProcessor(const ProcessorConfig& config);
+
+    // A summed-area table owned by the caller: entry (x, y) at data[y * stride + x]
+    // is the sum of the image pixels in [0, x) x [0, y), so the table is one
+    // larger than the image in each direction. Sums wrap modulo 2^32, which keeps
+    // boxSum() exact for any box of up to 2^32 / 255 pixels.
+    struct IntegralDesc {
+        std::uint32_t width;         // image width + 1
+        std::uint32_t height;        // image height + 1
+        std::uint32_t stride;        // elements between rows, at least width
+        std::uint32_t* data;
+    };
+
+    // Sum of the pixels in [x0, x1) x [y0, y1) in O(1)
+    inline std::uint32_t boxSum(const IntegralDesc& t, std::uint32_t x0, std::uint32_t y0,
+                                std::uint32_t x1, std::uint32_t y1) {
+        const std::uint32_t* top = t.data + static_cast<std::uint64_t>(y0) * t.stride;
+        const std::uint32_t* bottom = t.data + static_cast<std::uint64_t>(y1) * t.stride;
+        return bottom[x1] - bottom[x0] - top[x1] + top[x0];
+    }
+
+    struct AnalyzerConfig {
+        std::uint32_t structSize;    // sizeof(AnalyzerConfig) the caller was built with
+        std::uint32_t threads;       // worker threads; 0 means one per hardware thread
+        std::uint32_t flags;         // ProcessorFlags; only forceScalar applies
+    };
+
+    class IImageAnalyzer {
+    public:
+        // Summed-area table of one plane of in
+        virtual Status integral(const ImageDesc& in, std::uint32_t plane, const IntegralDesc& out) = 0;
+        // bins[v] = number of pixels of value v in one plane of in; bins has 256 entries
+        virtual Status histogram(const ImageDesc& in, std::uint32_t plane, std::uint32_t* bins) = 0;
+        // "avx2" or "scalar"
+        virtual const char* kernelName() const = 0;
+        virtual void release() = 0;  // Frees the analyzer and its scratch memory in this module
+
+    protected:
+        virtual ~IImageAnalyzer() = default;  // Not deletable by clients
+    };
+
+    AnalyzerConfig defaultAnalyzerConfig();
+
+    // Returns nullptr if config is invalid; release() the result when done
+    IImageAnalyzer* createAnalyzer(const AnalyzerConfig& config);
+}
+
+#endif // IMAGE_PROCESSOR_H